@@ -0,0 +1,529 @@
+/*
+ *
+ * Microbenchmarks for the hot paths of the game engine.
+ *
+ * Every benchmark runs across board sizes 2..10 (the sizes the options slider
+ * allows) and a few larger ones. Use Google Benchmark's flags for machine
+ * readable output, e.g.:
+ *   memory_bench --benchmark_format=json --benchmark_out=results.json
+ *
+ */
+
+// local
+#include "memory_core.hpp"
+
+// libs
+#include <benchmark/benchmark.h>
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace memory_game;
+
+// Board sizes every benchmark runs with
+void BoardSizes(benchmark::internal::Benchmark *benchmark) {
+  for (const std::int64_t size : {2, 4, 6, 8, 10, 16, 32, 64}) {
+    benchmark->Arg(size);
+  }
+}
+
+// Return size of the board being benchmarked
+std::uint32_t BoardSize(const benchmark::State &state) {
+  return static_cast<std::uint32_t>(state.range(0));
+}
+
+/* DynamicPackedBoolArray */
+
+void BM_PackedBoolArraySet(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+
+  std::size_t index = 0;
+  for (auto _ : state) {
+    array.Set(index, index & 1);
+    index = index + 1 < bits ? index + 1 : 0;
+  }
+
+  benchmark::DoNotOptimize(array.GetPtr());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PackedBoolArraySet)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayGetBit(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+
+  std::size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(array.GetBit(index));
+    index = index + 1 < bits ? index + 1 : 0;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PackedBoolArrayGetBit)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayCount(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+
+  for (std::size_t i = 0; i < bits; i += 3) {
+    array.Set(i, true);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(array.Count());
+  }
+
+  state.SetItemsProcessed(state.iterations() * bits);
+}
+BENCHMARK(BM_PackedBoolArrayCount)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayFindFirstUnset(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+
+  // Only the last bit is unset, so the whole array is scanned
+  for (std::size_t i = 0; i + 1 < bits; i++) {
+    array.Set(i, true);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(array.FindFirstUnset());
+  }
+
+  state.SetItemsProcessed(state.iterations() * bits);
+}
+BENCHMARK(BM_PackedBoolArrayFindFirstUnset)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayAndNot(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+  DynamicPackedBoolArray other(bits);
+
+  for (std::size_t i = 0; i < bits; i += 2) {
+    other.Set(i, true);
+  }
+
+  for (auto _ : state) {
+    array.AndNot(other);
+    benchmark::DoNotOptimize(array.GetPtr());
+  }
+
+  state.SetItemsProcessed(state.iterations() * bits);
+}
+BENCHMARK(BM_PackedBoolArrayAndNot)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayForEachSet(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array(bits);
+
+  for (std::size_t i = 0; i < bits; i += 3) {
+    array.Set(i, true);
+  }
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    array.ForEachSet([&sum](std::size_t i) { sum += i; });
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * bits);
+}
+BENCHMARK(BM_PackedBoolArrayForEachSet)->Apply(BoardSizes);
+
+void BM_PackedBoolArrayResize(benchmark::State &state) {
+  const std::size_t bits = BoardSize(state) * BoardSize(state);
+  DynamicPackedBoolArray array{};
+
+  for (auto _ : state) {
+    array.Resize(bits);
+    array.SetToZero();
+    benchmark::DoNotOptimize(array.GetPtr());
+  }
+}
+BENCHMARK(BM_PackedBoolArrayResize)->Apply(BoardSizes);
+
+/* MemoryLogic */
+
+void BM_InitializeBoard(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  logic.SetSeed(1);
+
+  for (auto _ : state) {
+    logic.InitializeBoard();
+    benchmark::DoNotOptimize(logic.GetBoard().data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * logic.GetTotalCardsCount());
+}
+BENCHMARK(BM_InitializeBoard)->Apply(BoardSizes);
+
+// Create a game and play the first turn on the default heap
+void BM_NewGameHeap(benchmark::State &state) {
+  for (auto _ : state) {
+    MemoryLogic logic(BoardSize(state), 2);
+    logic.SelectCard(0, 0);
+    benchmark::DoNotOptimize(logic.GetBoard().data());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewGameHeap)->Apply(BoardSizes);
+
+// Same as above with the game state in an arena from a slab pool
+void BM_NewGameArena(benchmark::State &state) {
+  SlabPool pool(GameArena::SizeFor(BoardSize(state), 2));
+
+  for (auto _ : state) {
+    GameArena arena(pool);
+    MemoryLogic logic(BoardSize(state), 2, &arena);
+    logic.SelectCard(0, 0);
+    benchmark::DoNotOptimize(logic.GetBoard().data());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NewGameArena)->Apply(BoardSizes);
+
+// One mismatched turn: reveal two different cards, then hide them again
+void BM_SelectCard(benchmark::State &state) {
+  const std::uint32_t size = BoardSize(state);
+  MemoryLogic logic(size, 2);
+  logic.InitializeBoard(1);
+
+  // Find a card that doesn't match the first one
+  const auto board = logic.GetBoard();
+  std::uint32_t other = 1;
+  while (board[other / size][other % size] == board[0][0]) {
+    other++;
+  }
+
+  for (auto _ : state) {
+    logic.SelectCard(0, 0);
+    logic.SelectCard(other / size, other % size);
+    logic.SelectCard(0, 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_SelectCard)->Apply(BoardSizes);
+
+// Card selections of a game publishing snapshots
+void BM_SelectCardPublishing(benchmark::State &state) {
+  const std::uint32_t size = BoardSize(state);
+  MemoryLogic logic(size, 2);
+  logic.InitializeBoard(1);
+
+  SnapshotPublisher publisher{};
+  logic.SetSnapshotPublisher(&publisher);
+
+  // Find a card that doesn't match the first one
+  const auto board = logic.GetBoard();
+  std::uint32_t other = 1;
+  while (board[other / size][other % size] == board[0][0]) {
+    other++;
+  }
+
+  for (auto _ : state) {
+    logic.SelectCard(0, 0);
+    logic.SelectCard(other / size, other % size);
+    logic.SelectCard(0, 0);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_SelectCardPublishing)->Apply(BoardSizes);
+
+// Acquiring and releasing the latest snapshot
+void BM_AcquireSnapshot(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+
+  SnapshotPublisher publisher{};
+  logic.SetSnapshotPublisher(&publisher);
+
+  for (auto _ : state) {
+    const SnapshotPublisher::Handle snapshot = publisher.Acquire();
+    benchmark::DoNotOptimize(snapshot->turn_number);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AcquireSnapshot)->Apply(BoardSizes);
+
+// Whole game played by perfect memory players
+void BM_PlayGame(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+
+  std::vector<std::unique_ptr<MovePolicy>> policies;
+  policies.push_back(std::make_unique<PerfectMemoryPolicy>());
+  policies.push_back(std::make_unique<PerfectMemoryPolicy>());
+
+  std::uint64_t seed = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PlayGame(logic, policies, seed++));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlayGame)->DenseRange(2, 10, 2)->Arg(16);
+
+// Solve every state of a board for the optimal player
+void BM_OptimalPlaySolver(benchmark::State &state) {
+  const std::uint32_t size = BoardSize(state);
+
+  for (auto _ : state) {
+    OptimalPlaySolver solver(size * size);
+    benchmark::DoNotOptimize(solver.GetExpectedMargin());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OptimalPlaySolver)->DenseRange(2, 10, 2)->Arg(16);
+
+// Whole game played by an optimal player against a perfect memory one
+void BM_PlayGameOptimal(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+
+  std::vector<std::unique_ptr<MovePolicy>> policies;
+  policies.push_back(std::make_unique<OptimalPolicy>());
+  policies.push_back(std::make_unique<PerfectMemoryPolicy>());
+
+  std::uint64_t seed = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PlayGame(logic, policies, seed++));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlayGameOptimal)->DenseRange(2, 10, 2)->Arg(16);
+
+/* Save and load */
+
+void BM_SerializeState(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  std::vector<std::byte> image{};
+
+  for (auto _ : state) {
+    logic.SerializeState(image);
+    benchmark::DoNotOptimize(image.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_SerializeState)->Apply(BoardSizes);
+
+void BM_LoadStateFromImage(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(logic.LoadStateFromImage(image));
+  }
+
+  state.SetBytesProcessed(state.iterations() * image.size());
+}
+BENCHMARK(BM_LoadStateFromImage)->Apply(BoardSizes);
+
+// Return a scratch file path unique to the benchmark
+std::filesystem::path ScratchFile(const benchmark::State &state) {
+  return std::filesystem::temp_directory_path() /
+         ("memory_bench_" + std::to_string(state.range(0)) + ".dat");
+}
+
+void BM_SaveState(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  const std::filesystem::path filename = ScratchFile(state);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(logic.SaveState(filename));
+  }
+
+  std::filesystem::remove(filename);
+}
+BENCHMARK(BM_SaveState)->Apply(BoardSizes);
+
+void BM_LoadState(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  const std::filesystem::path filename = ScratchFile(state);
+  logic.SaveState(filename);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(logic.LoadState(filename));
+  }
+
+  std::filesystem::remove(filename);
+}
+BENCHMARK(BM_LoadState)->Apply(BoardSizes);
+
+// Append to a save archive, compare with BM_SaveState
+void BM_ArchiveAppend(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+
+  const std::filesystem::path filename = ScratchFile(state);
+  {
+    SaveArchive archive(filename);
+
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(archive.Append(image, 0));
+    }
+  }
+
+  std::filesystem::remove(filename);
+  std::filesystem::remove(filename.string() + ".idx");
+}
+BENCHMARK(BM_ArchiveAppend)->Apply(BoardSizes);
+
+// Load one of many saves from a save archive, compare with BM_LoadState
+void BM_ArchiveLoad(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+
+  const std::filesystem::path filename = ScratchFile(state);
+  {
+    SaveArchive archive(filename);
+
+    std::vector<ArchiveSave> saves(1024, ArchiveSave{image, 0});
+    archive.AppendBatch(saves);
+
+    const std::vector<ArchiveEntry> entries =
+        archive.List(0, archive.GetCount());
+
+    std::size_t next = 0;
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(
+          archive.Load(entries[next++ % entries.size()].id, image));
+    }
+  }
+
+  std::filesystem::remove(filename);
+  std::filesystem::remove(filename.string() + ".idx");
+}
+BENCHMARK(BM_ArchiveLoad)->Apply(BoardSizes);
+
+// Autosave of one mismatched turn, compare with BM_SaveState
+void BM_AutosaveTurn(benchmark::State &state) {
+  const std::uint32_t size = BoardSize(state);
+  MemoryLogic logic(size, 2);
+  logic.InitializeBoard(1);
+
+  const std::filesystem::path filename = ScratchFile(state);
+  std::filesystem::remove(filename);
+  Autosave autosave(filename);
+  autosave.Commit(logic);
+
+  // Find a card that doesn't match the first one
+  const auto board = logic.GetBoard();
+  std::uint32_t other = 1;
+  while (board[other / size][other % size] == board[0][0]) {
+    other++;
+  }
+
+  const std::uint64_t written = autosave.GetBytesWritten();
+
+  for (auto _ : state) {
+    logic.SelectCard(0, 0);
+    autosave.Commit(logic);
+    logic.SelectCard(other / size, other % size);
+    autosave.Commit(logic);
+    logic.SelectCard(0, 0);
+    autosave.Commit(logic);
+  }
+
+  state.SetItemsProcessed(state.iterations() * 3);
+  state.counters["bytes_per_commit"] =
+      static_cast<double>(autosave.GetBytesWritten() - written) /
+      (state.iterations() * 3);
+
+  std::filesystem::remove(filename);
+}
+BENCHMARK(BM_AutosaveTurn)->Apply(BoardSizes);
+
+/* Journal */
+
+// Seek to a random move of a game played by forgetful players
+void BM_JournalSeek(benchmark::State &state) {
+  MemoryLogic logic(BoardSize(state), 2);
+  MoveJournal journal{};
+  logic.SetJournal(&journal);
+
+  std::vector<std::unique_ptr<MovePolicy>> policies;
+  policies.push_back(std::make_unique<RandomPolicy>());
+  policies.push_back(std::make_unique<RandomPolicy>());
+  PlayGame(logic, policies, 1);
+
+  logic.SetJournal(nullptr);
+  const JournalReplay replay(journal);
+
+  Xoshiro256PlusPlus rng(1);
+  for (auto _ : state) {
+    const std::size_t move = rng() % (journal.GetMoveCount() + 1);
+    benchmark::DoNotOptimize(replay.Seek(move, logic));
+  }
+
+  state.counters["moves"] = static_cast<double>(journal.GetMoveCount());
+  state.counters["bytes_per_move"] =
+      static_cast<double>(journal.GetMovesSize()) / journal.GetMoveCount();
+}
+BENCHMARK(BM_JournalSeek)->DenseRange(2, 10, 2)->Arg(16);
+
+// Selection with coordinates past the board, as sent by a bad client. Its
+// warning is rate limited after the first few.
+void BM_SelectCardOutOfBounds(benchmark::State &state) {
+  const std::uint32_t size = BoardSize(state);
+  MemoryLogic logic(size, 2);
+
+  const std::filesystem::path filename = ScratchFile(state);
+  Logger::Get().SetOutput(filename);
+
+  for (auto _ : state) {
+    logic.SelectCard(size, 0);
+  }
+
+  Logger::Get().Flush();
+  Logger::Get().SetOutput("debug_output.txt");
+  std::filesystem::remove(filename);
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SelectCardOutOfBounds)->Arg(4);
+
+// Record below the minimum level
+void BM_LogFiltered(benchmark::State &state) {
+  Logger logger(ScratchFile(state));
+  logger.SetMinLevel(LogLevel::warning);
+
+  for (auto _ : state) {
+    logger.Log(LogLevel::debug, "memory_bench", "Filtered");
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogFiltered)->Arg(0);
+
+} // namespace
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  // Record which bulk kernels the numbers were measured with
+  benchmark::AddCustomContext("packed_bits_kernels",
+                              packed_bits::GetKernels().name);
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ *
+ * Exact game analyser.
+ *
+ * Computes the exact chance of each player winning and the distribution of
+ * turn counts for every board size and player count in a range, with all
+ * players using the same memory policy. Defaults cover every game the
+ * options window allows.
+ *
+ * Usage: memory_analyse [--sizes A-B] [--players A-B]
+ *                       [--policy perfect|optimal] [--threads N]
+ *                       [--max-states N]
+ *
+ */
+
+// local
+#include "common.hpp"
+#include "game_analysis.hpp"
+
+// std
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// Turn counts less likely than this are left out of the printed distribution
+constexpr double kPrintThreshold = 0.0005;
+
+void PrintUsage() {
+  std::cerr << "Usage: memory_analyse [--sizes A-B] [--players A-B] "
+               "[--policy perfect|optimal] [--threads N] "
+               "[--max-states N]\n";
+}
+
+// Parse "A-B" or "A" into first, last
+bool ParseRange(std::string_view text, std::uint32_t &first,
+                std::uint32_t &last) {
+  const std::size_t dash = text.find('-');
+
+  if (!parse_number(text.substr(0, dash), first)) {
+    return false;
+  }
+
+  last = first;
+  if (dash != std::string_view::npos &&
+      !parse_number(text.substr(dash + 1), last)) {
+    return false;
+  }
+
+  return first <= last;
+}
+
+void PrintResult(const memory_game::AnalysisResult &result) {
+  if (result.wins_complete) {
+    for (std::size_t i = 0; i < result.win_probability.size(); i++) {
+      std::cout << "  Player " << i + 1 << " wins: "
+                << result.win_probability[i] << "\n";
+    }
+    std::cout << "  Tie:          " << result.tie_probability << "\n";
+  } else {
+    std::cout << "  Wins:         skipped, too many states\n";
+  }
+
+  if (!result.turns_complete) {
+    std::cout << "  Turns:        skipped, too many states\n";
+    return;
+  }
+
+  std::cout << "  Mean turns:   " << result.MeanTurns() << "\n"
+            << "  Turns:       ";
+  for (const auto &[turns, probability] : result.turn_distribution) {
+    if (probability >= kPrintThreshold) {
+      std::cout << " " << turns << ":" << probability;
+    }
+  }
+  std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  memory_game::AnalysisConfig config{};
+  std::uint32_t first_size = 2, last_size = 100;
+  std::uint32_t first_players = 1, last_players = 5;
+  std::uint32_t thread_count = 0;
+  std::string policy_name = "perfect";
+
+  // Parse arguments
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+
+    const char *value = argv[++i];
+    bool valid = true;
+
+    if (arg == "--sizes") {
+      valid = ParseRange(value, first_size, last_size);
+    } else if (arg == "--players") {
+      valid = ParseRange(value, first_players, last_players);
+    } else if (arg == "--policy") {
+      policy_name = value;
+      valid = memory_game::ParseAnalysisPolicy(policy_name, config.policy);
+    } else if (arg == "--threads") {
+      valid = parse_number(value, thread_count);
+    } else if (arg == "--max-states") {
+      valid = parse_number(value, config.max_states);
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The board is filled with pairs, the key holds up to 8 players
+  if (first_size == 0 || first_players == 0 || last_players > 8) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  memory_game::WorkStealingPool pool(thread_count);
+
+  std::cout << "Policy:       " << policy_name << "\n"
+            << "Threads:      " << pool.GetThreadCount() << "\n"
+            << std::setprecision(6);
+
+  // Odd sizes have no complete board
+  for (std::uint32_t size = first_size + first_size % 2; size <= last_size;
+       size += 2) {
+    for (std::uint32_t players = first_players; players <= last_players;
+         players++) {
+      config.board_size = size;
+      config.player_count = players;
+
+      const memory_game::AnalysisResult result =
+          memory_game::AnalyseGame(config, pool);
+
+      std::cout << "\n"
+                << size << "x" << size << ", " << players << " players ("
+                << result.state_count << " states, "
+                << result.elapsed_seconds << " s)\n";
+      PrintResult(result);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
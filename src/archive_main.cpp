@@ -0,0 +1,103 @@
+/*
+ *
+ * Save archive tool.
+ *
+ * Lists the saves of a pack file and moves saves between save directories
+ * and packs in bulk.
+ *
+ * Usage: memory_archive <pack> list
+ *        memory_archive <pack> import <directory> [--remove] [--threads N]
+ *        memory_archive <pack> export <directory>
+ *
+ */
+
+// local
+#include "common.hpp"
+#include "save_archive.hpp"
+#include "work_stealing_pool.hpp"
+
+// std
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: memory_archive <pack> list\n"
+               "       memory_archive <pack> import <directory> [--remove] "
+               "[--threads N]\n"
+               "       memory_archive <pack> export <directory>\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  const std::string_view command = argv[2];
+
+  memory_game::SaveArchive archive(argv[1]);
+  if (!archive.IsOpen()) {
+    std::cerr << "Unable to open " << argv[1] << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (command == "list" && argc == 3) {
+    for (const memory_game::ArchiveEntry &entry :
+         archive.List(0, archive.GetCount())) {
+      std::cout << entry.id << "  "
+                << get_human_readable_timestamp(
+                       std::to_string(entry.timestamp))
+                << "  " << entry.image_size << " -> " << entry.data_size
+                << " bytes\n";
+    }
+    return EXIT_SUCCESS;
+  }
+
+  if (command == "export" && argc == 4) {
+    std::cout << "Exported " << archive.Export(argv[3]) << " of "
+              << archive.GetCount() << " saves\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (command != "import" || argc < 4) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  // Parse arguments
+  bool remove_files = false;
+  std::uint32_t thread_count = 0;
+
+  for (int i = 4; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    bool valid = true;
+
+    if (arg == "--remove") {
+      remove_files = true;
+    } else if (arg == "--threads" && i + 1 < argc) {
+      valid = parse_number(argv[++i], thread_count);
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  memory_game::WorkStealingPool pool(thread_count);
+
+  std::cout << "Imported " << archive.Import(argv[3], remove_files, &pool)
+            << " saves\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,411 @@
+// header
+#include "autosave.hpp"
+
+// local
+#include "save_format.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory_game {
+
+namespace {
+
+// Offset of the record of slot i
+constexpr std::uint64_t kRecordOffsets[2] = {0, 512};
+
+// Slots start after the records and are aligned to whole pages
+constexpr std::uint64_t kSlotAlignment = 4096;
+
+// Record bytes covered by record_crc
+constexpr std::size_t kRecordCrcSize = offsetof(AutosaveRecord, record_crc);
+
+constexpr std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+/* Platform file access */
+
+#ifdef _WIN32
+
+Autosave::Autosave(const std::filesystem::path &filename) {
+  m_File = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                       FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_File == INVALID_HANDLE_VALUE) {
+    m_File = nullptr;
+    throw std::system_error(static_cast<int>(GetLastError()),
+                            std::system_category(),
+                            "open " + filename.string());
+  }
+
+  LARGE_INTEGER size{};
+  GetFileSizeEx(m_File, &size);
+  m_FileSize = static_cast<std::uint64_t>(size.QuadPart);
+
+  Open();
+}
+
+Autosave::~Autosave() { CloseHandle(m_File); }
+
+bool Autosave::WriteAt(const void *data, std::size_t size,
+                       std::uint64_t offset) {
+  OVERLAPPED position{};
+  position.Offset = static_cast<DWORD>(offset);
+  position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+  DWORD written = 0;
+  if (!WriteFile(m_File, data, static_cast<DWORD>(size), &written,
+                 &position) ||
+      written != size) {
+    return false;
+  }
+
+  m_BytesWritten += size;
+  return true;
+}
+
+bool Autosave::ReadAt(void *data, std::size_t size,
+                      std::uint64_t offset) const {
+  OVERLAPPED position{};
+  position.Offset = static_cast<DWORD>(offset);
+  position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+  DWORD read = 0;
+  return ReadFile(m_File, data, static_cast<DWORD>(size), &read, &position) &&
+         read == size;
+}
+
+bool Autosave::Sync() { return FlushFileBuffers(m_File); }
+
+bool Autosave::Preallocate(std::uint64_t size) {
+  if (size <= m_FileSize) {
+    return true;
+  }
+
+  LARGE_INTEGER end{};
+  end.QuadPart = static_cast<LONGLONG>(size);
+  if (!SetFilePointerEx(m_File, end, nullptr, FILE_BEGIN) ||
+      !SetEndOfFile(m_File)) {
+    return false;
+  }
+
+  m_FileSize = size;
+  return true;
+}
+
+#else
+
+Autosave::Autosave(const std::filesystem::path &filename) {
+  m_Fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (m_Fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "open " + filename.string());
+  }
+
+  struct stat info {};
+  if (fstat(m_Fd, &info) == 0) {
+    m_FileSize = static_cast<std::uint64_t>(info.st_size);
+  }
+
+  Open();
+}
+
+Autosave::~Autosave() { close(m_Fd); }
+
+bool Autosave::WriteAt(const void *data, std::size_t size,
+                       std::uint64_t offset) {
+  const auto *bytes = static_cast<const std::byte *>(data);
+
+  for (std::size_t written = 0; written < size;) {
+    const ssize_t result = pwrite(m_Fd, bytes + written, size - written,
+                                  static_cast<off_t>(offset + written));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+
+    written += static_cast<std::size_t>(result);
+  }
+
+  m_BytesWritten += size;
+  return true;
+}
+
+bool Autosave::ReadAt(void *data, std::size_t size,
+                      std::uint64_t offset) const {
+  auto *bytes = static_cast<std::byte *>(data);
+
+  for (std::size_t read = 0; read < size;) {
+    const ssize_t result = pread(m_Fd, bytes + read, size - read,
+                                 static_cast<off_t>(offset + read));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+
+    read += static_cast<std::size_t>(result);
+  }
+
+  return true;
+}
+
+bool Autosave::Sync() {
+#ifdef __linux__
+  return fdatasync(m_Fd) == 0;
+#else
+  return fsync(m_Fd) == 0;
+#endif
+}
+
+bool Autosave::Preallocate(std::uint64_t size) {
+  if (size <= m_FileSize) {
+    return true;
+  }
+
+#ifdef __linux__
+  // Allocating the blocks up front keeps later in place writes from failing
+  // on a full disk. Not every file system supports it.
+  const int error = posix_fallocate(m_Fd, 0, static_cast<off_t>(size));
+  if (error != 0 && error != EOPNOTSUPP && error != EINVAL) {
+    return false;
+  }
+  if (error != 0 && ftruncate(m_Fd, static_cast<off_t>(size)) != 0) {
+    return false;
+  }
+#else
+  if (ftruncate(m_Fd, static_cast<off_t>(size)) != 0) {
+    return false;
+  }
+#endif
+
+  m_FileSize = size;
+  return true;
+}
+
+#endif
+
+/* Autosave */
+
+void Autosave::Open() {
+  // Pick up the slots of an existing file. Their contents are rewritten in
+  // full the first time they're committed to.
+  for (std::uint32_t i = 0; i < 2; i++) {
+    AutosaveRecord record{};
+    if (!ReadRecord(i, record)) {
+      continue;
+    }
+
+    m_Slots[i].offset = record.slot_offset;
+    m_Slots[i].capacity = record.slot_capacity;
+
+    if (record.generation > m_Generation) {
+      m_Generation = record.generation;
+      m_Active = i;
+    }
+  }
+}
+
+bool Autosave::Commit(MemoryLogic &logic) {
+  logic.SerializeState(m_Image);
+
+  const bool committed = Commit(m_Image, logic.GetDirtyRows());
+
+  // On failure the slots fall back to full writes, nothing is lost
+  logic.ClearDirtyRows();
+
+  return committed;
+}
+
+bool Autosave::Commit(std::span<const std::byte> image,
+                      const DynamicPackedBoolArray &dirty_rows) {
+  SaveHeader header{};
+  std::memcpy(&header, image.data(), sizeof(header));
+
+  const std::uint32_t size = header.board_size;
+  const SaveLayout layout =
+      SaveLayout::For(size, header.player_count, header.card_width);
+  const std::size_t row_bytes = size * layout.card_width;
+
+  // Queue the changed rows for both slots, forget slots of another game shape
+  for (Slot &slot : m_Slots) {
+    if (slot.board_size != size || slot.player_count != header.player_count ||
+        dirty_rows.GetSizeInBits() != size) {
+      slot.known = false;
+    }
+
+    if (slot.known) {
+      slot.pending.Or(dirty_rows);
+    }
+  }
+
+  // Never touch the slot holding the newest state
+  const std::uint32_t target = m_Generation == 0 ? 0 : 1 - m_Active;
+  Slot &slot = m_Slots[target];
+  const Slot &other = m_Slots[1 - target];
+
+  // Move the slot if the image outgrew it, below the other slot if it fits
+  // there, else after it
+  if (slot.capacity < image.size()) {
+    slot.capacity = AlignUp(image.size(), kSlotAlignment);
+
+    if (other.capacity == 0 ||
+        kSlotAlignment + slot.capacity <= other.offset) {
+      slot.offset = kSlotAlignment;
+    } else {
+      slot.offset = other.offset + other.capacity;
+    }
+
+    slot.known = false;
+  }
+
+  if (!Preallocate(std::max(slot.offset + slot.capacity, m_FileSize))) {
+    slot.known = false;
+    return false;
+  }
+
+  // Write whole image to an unknown slot, else header, counters and the
+  // board and mask words of changed rows
+  bool written = true;
+
+  const auto write = [&](std::size_t begin, std::size_t end) {
+    written = written && WriteAt(image.data() + begin, end - begin,
+                                 slot.offset + begin);
+  };
+
+  if (!slot.known) {
+    write(0, image.size());
+  } else {
+    write(0, layout.board_offset);
+
+    for (std::size_t first = slot.pending.FindFirstSet();
+         first != DynamicPackedBoolArray::kNotFound;) {
+      std::size_t last = slot.pending.FindFirstUnset(first);
+      if (last == DynamicPackedBoolArray::kNotFound) {
+        last = size;
+      }
+
+      // Rows first..last - 1 of the board and the words holding their bits
+      const std::size_t first_word = first * size / 64;
+      const std::size_t end_word = (last * size + 63) / 64;
+
+      write(layout.board_offset + first * row_bytes,
+            layout.board_offset + last * row_bytes);
+      write(layout.revealed_offset + first_word * sizeof(std::uint64_t),
+            layout.revealed_offset + end_word * sizeof(std::uint64_t));
+      write(layout.matched_offset + first_word * sizeof(std::uint64_t),
+            layout.matched_offset + end_word * sizeof(std::uint64_t));
+
+      first = last < size ? slot.pending.FindFirstSet(last)
+                          : DynamicPackedBoolArray::kNotFound;
+    }
+  }
+
+  // The image must be on disk before the record pointing at it
+  if (!written || !Sync()) {
+    slot.known = false;
+    return false;
+  }
+
+  AutosaveRecord record{};
+  std::memcpy(record.magic, kAutosaveMagic, sizeof(kAutosaveMagic));
+  record.version = kAutosaveVersion;
+  record.slot = target;
+  record.generation = m_Generation + 1;
+  record.slot_offset = slot.offset;
+  record.slot_capacity = slot.capacity;
+  record.image_size = image.size();
+  record.image_crc = header.header_crc;
+  record.record_crc = Crc32(std::span<const std::byte>(
+      reinterpret_cast<const std::byte *>(&record), kRecordCrcSize));
+
+  if (!WriteAt(&record, sizeof(record), kRecordOffsets[target]) || !Sync()) {
+    slot.known = false;
+    return false;
+  }
+
+  m_Generation++;
+  m_Active = target;
+
+  slot.known = true;
+  slot.board_size = size;
+  slot.player_count = header.player_count;
+  slot.pending.Resize(size);
+  slot.pending.SetToZero();
+
+  return true;
+}
+
+bool Autosave::ReadLatest(std::vector<std::byte> &image) const {
+  AutosaveRecord records[2]{};
+  const bool valid[2] = {ReadRecord(0, records[0]), ReadRecord(1, records[1])};
+
+  // Newest slot first
+  const std::uint32_t newest =
+      valid[1] && (!valid[0] || records[1].generation > records[0].generation)
+          ? 1
+          : 0;
+
+  for (const std::uint32_t i : {newest, 1 - newest}) {
+    const AutosaveRecord &record = records[i];
+    if (!valid[i] || record.image_size > record.slot_capacity) {
+      continue;
+    }
+
+    std::vector<std::byte> data(record.image_size);
+    std::string error{};
+
+    if (ReadAt(data.data(), data.size(), record.slot_offset) &&
+        data.size() >= sizeof(SaveHeader) &&
+        reinterpret_cast<const SaveHeader *>(data.data())->header_crc ==
+            record.image_crc &&
+        SaveView::Parse(data, error)) {
+      image = std::move(data);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Autosave::ReadRecord(std::uint32_t slot, AutosaveRecord &record) const {
+  if (!ReadAt(&record, sizeof(record), kRecordOffsets[slot])) {
+    return false;
+  }
+
+  const auto bytes = std::span<const std::byte>(
+      reinterpret_cast<const std::byte *>(&record), kRecordCrcSize);
+
+  return std::memcmp(record.magic, kAutosaveMagic, sizeof(kAutosaveMagic)) ==
+             0 &&
+         record.version == kAutosaveVersion && record.slot == slot &&
+         record.slot_offset >= kSlotAlignment &&
+         record.record_crc == Crc32(bytes);
+}
+
+} // namespace memory_game
@@ -0,0 +1,152 @@
+/*
+ *
+ * Crash safe autosave file, version 1.
+ *
+ * The file holds two slots, each with room for a save image (see
+ * save_format.hpp), and a commit record per slot. A commit writes the new
+ * state into the slot that doesn't hold the newest state, flushes it, then
+ * writes that slot's record with a higher generation and flushes again. The
+ * record is the commit marker: a crash at any point leaves at least one slot
+ * whose record and image check out, and loading picks the newest of those.
+ *
+ * Slots are preallocated and updated in place with positional writes. Only
+ * the header, the player counters and the board and mask words of rows that
+ * changed since the slot was last written go to disk, so a move costs a few
+ * hundred bytes however large the board is.
+ *
+ * Layout, all integers little endian:
+ *   offset  size  field
+ *        0    64  record of slot 0
+ *      512    64  record of slot 1 (own sector, a torn write hits one record)
+ *     4096        slots, each at the offset its record names
+ *
+ * Record:
+ *        0     8  magic "MEMAUTO\0"
+ *        8     4  format version (1)
+ *       12     4  slot index
+ *       16     8  generation, higher is newer
+ *       24     8  slot offset in bytes
+ *       32     8  slot capacity in bytes
+ *       40     8  image size in bytes
+ *       48     4  header CRC of the image in the slot
+ *       52     8  reserved, 0
+ *       60     4  CRC-32 of record bytes 0..59
+ *
+ */
+
+#pragma once
+
+// local
+#include "dynamic_packed_bool_array.hpp"
+#include "memory_logic.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace memory_game {
+
+// Magic at the start of every autosave record
+inline constexpr char kAutosaveMagic[8] = {'M', 'E', 'M', 'A',
+                                           'U', 'T', 'O', '\0'};
+
+// Current autosave format version
+inline constexpr std::uint32_t kAutosaveVersion = 1;
+
+// Autosave commit record, see the layout above
+struct AutosaveRecord {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t slot;
+  std::uint64_t generation;
+  std::uint64_t slot_offset;
+  std::uint64_t slot_capacity;
+  std::uint64_t image_size;
+  std::uint32_t image_crc;
+  std::uint32_t reserved[2];
+  std::uint32_t record_crc;
+};
+
+static_assert(sizeof(AutosaveRecord) == 64,
+              "Autosave record must be 64 bytes");
+
+// Incrementally updated autosave of one game. Not thread safe, use it from
+// one thread at a time.
+class Autosave {
+public:
+  // Open filename, creating it if it doesn't exist. Throws std::system_error
+  // if it can't be opened.
+  explicit Autosave(const std::filesystem::path &filename);
+
+  Autosave(const Autosave &) = delete;
+  Autosave &operator=(const Autosave &) = delete;
+
+  ~Autosave();
+
+  // Commit logic's changes since the last commit and clear its dirty rows.
+  // Returns false if the file couldn't be written.
+  bool Commit(MemoryLogic &logic);
+
+  // Commit image (MemoryLogic::SerializeState) of a game whose rows outside
+  // dirty_rows didn't change since the previous commit. dirty_rows of another
+  // size than the board marks every row. Returns false if the file couldn't
+  // be written.
+  bool Commit(std::span<const std::byte> image,
+              const DynamicPackedBoolArray &dirty_rows);
+
+  // Read the newest committed save image. Returns false if there is none.
+  bool ReadLatest(std::vector<std::byte> &image) const;
+
+  // Return bytes written to the file so far, records included
+  std::uint64_t GetBytesWritten() const { return m_BytesWritten; }
+
+private:
+  struct Slot {
+    std::uint64_t offset = 0;
+    std::uint64_t capacity = 0;
+
+    // Whether the slot holds a complete image of board_size, player_count
+    // that differs from the current game only in pending rows
+    bool known = false;
+    std::uint32_t board_size = 0;
+    std::uint32_t player_count = 0;
+    DynamicPackedBoolArray pending{};
+  };
+
+  // Find the slots of an existing file
+  void Open();
+
+  // Read record of slot, returns false if it isn't valid
+  bool ReadRecord(std::uint32_t slot, AutosaveRecord &record) const;
+
+  // Write size bytes at offset, returns false on error
+  bool WriteAt(const void *data, std::size_t size, std::uint64_t offset);
+
+  // Read size bytes at offset, returns false on error or end of file
+  bool ReadAt(void *data, std::size_t size, std::uint64_t offset) const;
+
+  // Flush written data to the device
+  bool Sync();
+
+  // Grow the file to size bytes with its blocks allocated
+  bool Preallocate(std::uint64_t size);
+
+  Slot m_Slots[2]{};
+  std::uint32_t m_Active = 0; // Slot holding the newest state
+  std::uint64_t m_Generation = 0;
+  std::uint64_t m_FileSize = 0;
+  std::uint64_t m_BytesWritten = 0;
+
+  std::vector<std::byte> m_Image{}; // Reused by Commit(MemoryLogic &)
+
+#ifdef _WIN32
+  void *m_File = nullptr; // File handle
+#else
+  int m_Fd = -1;
+#endif
+};
+
+} // namespace memory_game
@@ -0,0 +1,103 @@
+// header
+#include "background_renderer.hpp"
+
+// libs
+// FTXUI includes
+#include <ftxui/dom/canvas.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace memory_game {
+
+// Update mouse position in canvas (braille dot) coordinates
+void BackgroundRenderer::SetMouse(float mouse_x, float mouse_y) {
+  if (mouse_x != m_MouseX || mouse_y != m_MouseY) {
+    m_MouseX = mouse_x;
+    m_MouseY = mouse_y;
+    m_Canvas = nullptr;
+  }
+}
+
+// Return background canvas for a width x height dot canvas
+ftxui::Element BackgroundRenderer::Render(std::int32_t width,
+                                          std::int32_t height) {
+  if (m_Canvas != nullptr && width == m_Width && height == m_Height) {
+    return m_Canvas;
+  }
+
+  m_Width = width;
+  m_Height = height;
+
+  // Initialize dynamic canvas component
+  auto c = ftxui::Canvas(width, height);
+
+  // Set size and transformation offset
+  const std::int32_t size = std::max(width, height);
+  const std::int32_t offset = size;
+
+  ComputeFactors(size);
+
+  // Height of the surface at grid point (x, y)
+  const auto surface = [this](std::int32_t x, std::int32_t y) {
+    return -1.5f + 3.0f * m_FactorsX[x] * m_FactorsY[y];
+  };
+
+  // Grid point (x, y) is drawn at (5x + 3y - offset, offset - 5y - 5h), with
+  // the height h in [-1.5, 1.5]. Lines into row y also touch row y - 1 and
+  // column x - 1, so keep a margin of a grid step plus the height swing.
+  constexpr std::int32_t margin = 5 + 8;
+
+  // Rows on the canvas: offset - 5y in [-margin, height + margin)
+  const std::int32_t y_begin =
+      std::max(0, (offset - height - margin) / 5);
+  const std::int32_t y_end = std::min(size, (offset + margin) / 5 + 1);
+
+  for (std::int32_t y = y_begin; y < y_end; y++) {
+    // Columns on the canvas: 5x + 3y - offset in [-margin, width + margin)
+    const std::int32_t x_begin = std::max(0, (offset - 3 * y - margin) / 5);
+    const std::int32_t x_end =
+        std::min(size, (width + offset - 3 * y + margin) / 5 + 1);
+
+    for (std::int32_t x = x_begin; x < x_end; x++) {
+      const std::int32_t point_x = 5 * x + 3 * y - offset;
+      const float point_y = offset - 5 * y - 5 * surface(x, y);
+
+      if (x != 0) {
+        c.DrawPointLine(point_x - 5, offset - 5 * y - 5 * surface(x - 1, y),
+                        point_x, point_y);
+      }
+      if (y != 0) {
+        c.DrawPointLine(point_x - 3,
+                        offset - 5 * (y - 1) - 5 * surface(x, y - 1), point_x,
+                        point_y);
+      }
+    }
+  }
+
+  m_Canvas = ftxui::canvas(std::move(c));
+  return m_Canvas;
+}
+
+// Recompute the separable height factors for the current mouse position
+void BackgroundRenderer::ComputeFactors(std::int32_t size) {
+  const std::int32_t offset = size;
+
+  // Black magic math
+  const float my = (m_MouseY - offset) / -5.f;
+  const float mx = (m_MouseX - 3 * my + offset) / 5.f;
+
+  m_FactorsX.resize(size);
+  m_FactorsY.resize(size);
+
+  for (std::int32_t i = 0; i < size; i++) {
+    const float dx = i - mx;
+    const float dy = i - my;
+    m_FactorsX[i] = std::exp(-0.2f * dx * dx);
+    m_FactorsY[i] = std::exp(-0.2f * dy * dy);
+  }
+}
+
+} // namespace memory_game
@@ -0,0 +1,45 @@
+#pragma once
+
+// libs
+// FTXUI includes
+#include <ftxui/dom/elements.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace memory_game {
+
+// Draws the wavy background surface that follows the mouse.
+//
+// The surface is a Gaussian bump, exp(-0.2 * (dx^2 + dy^2)), which factors
+// into exp(-0.2 * dx^2) * exp(-0.2 * dy^2). So a surface of size x size needs
+// only 2 * size exp calls, cached until the mouse moves. Only the grid lines
+// that land on the canvas are drawn, and the finished canvas element is
+// reused until the mouse or the screen size changes.
+class BackgroundRenderer {
+public:
+  // Update mouse position in canvas (braille dot) coordinates
+  void SetMouse(float mouse_x, float mouse_y);
+
+  // Return background canvas for a width x height dot canvas
+  ftxui::Element Render(std::int32_t width, std::int32_t height);
+
+private:
+  // Recompute the separable height factors for the current mouse position
+  void ComputeFactors(std::int32_t size);
+
+  float m_MouseX = 0.0f;
+  float m_MouseY = 0.0f;
+
+  // exp(-0.2 * (x - mx)^2) per column and exp(-0.2 * (y - my)^2) per row
+  std::vector<float> m_FactorsX{};
+  std::vector<float> m_FactorsY{};
+
+  // Cached canvas and the input it was drawn for
+  ftxui::Element m_Canvas{};
+  std::int32_t m_Width = -1;
+  std::int32_t m_Height = -1;
+};
+
+} // namespace memory_game
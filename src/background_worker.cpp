@@ -0,0 +1,51 @@
+// header
+#include "background_worker.hpp"
+
+// std
+#include <utility>
+
+namespace memory_game {
+
+BackgroundWorker::BackgroundWorker() : m_Thread([this] { Run(); }) {}
+
+BackgroundWorker::~BackgroundWorker() {
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Stopping = true;
+  }
+
+  m_Condition.notify_one();
+  m_Thread.join();
+}
+
+void BackgroundWorker::Submit(std::function<void()> task) {
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Tasks.push_back(std::move(task));
+  }
+
+  m_Condition.notify_one();
+}
+
+void BackgroundWorker::Run() {
+  for (;;) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock lock(m_Mutex);
+      m_Condition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+
+      // Drain the queue before stopping so no save is lost
+      if (m_Tasks.empty()) {
+        return;
+      }
+
+      task = std::move(m_Tasks.front());
+      m_Tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+} // namespace memory_game
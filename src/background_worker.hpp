@@ -0,0 +1,39 @@
+#pragma once
+
+// std
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace memory_game {
+
+// Single background thread running submitted tasks in order. Used to keep
+// disk I/O off the UI thread.
+class BackgroundWorker {
+public:
+  BackgroundWorker();
+
+  BackgroundWorker(const BackgroundWorker &) = delete;
+  BackgroundWorker &operator=(const BackgroundWorker &) = delete;
+
+  // Finish queued tasks and join the thread
+  ~BackgroundWorker();
+
+  // Queue task to run on the worker thread
+  void Submit(std::function<void()> task);
+
+private:
+  // Worker thread loop
+  void Run();
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  std::deque<std::function<void()>> m_Tasks{}; // Guarded by m_Mutex
+  bool m_Stopping = false;                     // Guarded by m_Mutex
+
+  std::thread m_Thread; // Started last, once everything else is constructed
+};
+
+} // namespace memory_game
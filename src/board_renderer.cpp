@@ -0,0 +1,170 @@
+// header
+#include "board_renderer.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace memory_game {
+
+// Return the cards of the current game state that fit into the viewport
+ftxui::Element BoardRenderer::Render(const MemoryLogic &logic,
+                                     const std::int32_t current_x,
+                                     const std::int32_t current_y,
+                                     const std::int32_t width,
+                                     const std::int32_t height) {
+  const std::uint32_t board_size = logic.GetBoardSize();
+
+  // Cell size depends on the board size, so start over
+  if (board_size != m_BoardSize) {
+    m_BoardSize = board_size;
+
+    // Leave room for the border and the longest symbol on the board
+    const std::uint32_t symbol_length =
+        board_size < 2
+            ? 1
+            : GetCardSymbol(board_size * board_size / 2 - 1).length;
+
+    m_CellWidth = std::max<std::uint32_t>(
+        static_cast<std::uint32_t>(std::ceil(60.0f / board_size)),
+        symbol_length + 2);
+    m_CellHeight = std::max<std::uint32_t>(
+        static_cast<std::uint32_t>(std::ceil(30.0f / board_size)), 3);
+
+    m_Top = 0;
+    m_Left = 0;
+    m_Rows = 0;
+    m_Columns = 0;
+  }
+
+  // Cells that fit, minus a line for the scroll indicator if not all of
+  // them do
+  const auto fit = [](std::int32_t space, std::uint32_t cell,
+                      std::uint32_t board_size) {
+    return std::clamp<std::uint32_t>(
+        static_cast<std::uint32_t>(std::max(space, 0)) / cell, 1,
+        std::max<std::uint32_t>(board_size, 1));
+  };
+
+  const std::uint32_t columns = fit(width, m_CellWidth, board_size);
+  std::uint32_t rows = fit(height, m_CellHeight, board_size);
+  if (rows < board_size || columns < board_size) {
+    rows = fit(height - 1, m_CellHeight, board_size);
+  }
+
+  const std::uint32_t top = Scroll(m_Top, current_x, rows, board_size);
+  const std::uint32_t left = Scroll(m_Left, current_y, columns, board_size);
+
+  // Another window of the board, cached cells show the wrong cards
+  if (top != m_Top || left != m_Left || rows != m_Rows ||
+      columns != m_Columns || m_States.size() != rows * columns) {
+    m_Top = top;
+    m_Left = left;
+    m_Rows = rows;
+    m_Columns = columns;
+
+    m_States.assign(rows * columns, CellState{});
+    m_Cells.assign(rows, ftxui::Elements(columns));
+    m_Board = nullptr;
+  }
+
+  if (board_size == 0) {
+    return ftxui::emptyElement();
+  }
+
+  const auto board = logic.GetBoard();
+  const auto revealed = logic.GetHasCardBeenRevealed();
+  const auto matched = logic.GetHasCardBeenMatched();
+
+  for (std::uint32_t row = 0; row < rows; ++row) {
+    for (std::uint32_t column = 0; column < columns; ++column) {
+      const std::uint32_t i = top + row;
+      const std::uint32_t j = left + column;
+
+      CellState state{};
+      state.revealed = revealed[i][j];
+      state.card = state.revealed ? board[i][j] : 0;
+      state.matched = matched[i][j];
+      state.selected = static_cast<std::int32_t>(i) == current_x &&
+                       static_cast<std::int32_t>(j) == current_y;
+
+      CellState &cached_state = m_States[row * columns + column];
+
+      // Rebuild only cells that look different now
+      if (m_Cells[row][column] == nullptr || state != cached_state) {
+        cached_state = state;
+        m_Cells[row][column] = CreateCell(state);
+        m_Board = nullptr;
+      }
+    }
+  }
+
+  if (m_Board == nullptr) {
+    if (rows == board_size && columns == board_size) {
+      m_Board = ftxui::gridbox(m_Cells) | ftxui::center;
+    } else {
+      // Tell where in the board the view is
+      m_Board =
+          ftxui::vbox({
+              ftxui::gridbox(m_Cells) | ftxui::center,
+              ftxui::text("Rows " + std::to_string(top + 1) + "-" +
+                          std::to_string(top + rows) + ", columns " +
+                          std::to_string(left + 1) + "-" +
+                          std::to_string(left + columns) + " of " +
+                          std::to_string(board_size)) |
+                  ftxui::color(ftxui::Color::Grey50) | ftxui::center,
+          }) |
+          ftxui::center;
+    }
+  }
+
+  return m_Board;
+}
+
+// Build element for a single cell
+ftxui::Element BoardRenderer::CreateCell(const CellState &state) const {
+  ftxui::Element cell;
+  ftxui::Decorator color;
+
+  // Determine the content of the cell
+  if (state.revealed) {
+    cell = ftxui::text(std::string(GetCardSymbol(state.card).view()));
+    color = ftxui::color(ftxui::Color::White);
+  } else {
+    cell = ftxui::text("*");
+    color = ftxui::color(ftxui::Color::Grey50);
+  }
+
+  // If the cell is the one user selected light it in blue
+  if (state.selected) {
+    color = ftxui::color(ftxui::Color::Blue);
+  } else if (state.matched) {
+    color = ftxui::color(ftxui::Color::Green);
+  }
+
+  return cell | ftxui::bold | ftxui::center | ftxui::border | color |
+         ftxui::size(ftxui::WIDTH, ftxui::GREATER_THAN, m_CellWidth) |
+         ftxui::size(ftxui::HEIGHT, ftxui::GREATER_THAN, m_CellHeight);
+}
+
+// Move the first visible row or column so that current is visible
+std::uint32_t BoardRenderer::Scroll(const std::uint32_t first,
+                                    const std::int32_t current,
+                                    const std::uint32_t count,
+                                    const std::uint32_t board_size) {
+  const std::int32_t last = std::max<std::int32_t>(board_size, 1) - 1;
+  const auto target =
+      static_cast<std::uint32_t>(std::clamp<std::int32_t>(current, 0, last));
+
+  std::uint32_t result = first;
+  if (target < result) {
+    result = target;
+  } else if (target >= result + count) {
+    result = target - count + 1;
+  }
+
+  return std::min(result, board_size > count ? board_size - count : 0);
+}
+
+} // namespace memory_game
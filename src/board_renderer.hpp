@@ -0,0 +1,70 @@
+#pragma once
+
+// local
+#include "memory_logic.hpp"
+
+// libs
+// FTXUI includes
+#include <ftxui/dom/elements.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace memory_game {
+
+// Retained, virtualized board view. Only the cells that fit into the
+// viewport are turned into elements, scrolled so the cursor stays in view,
+// so a frame costs the same on a 6x6 board as on a 100x100 one. Between
+// frames the visible cells are kept and only those whose state changed are
+// rebuilt.
+class BoardRenderer {
+public:
+  // Return the cards of the current game state that fit into a viewport of
+  // width x height terminal cells, with a scroll indicator if some don't
+  ftxui::Element Render(const MemoryLogic &logic, std::int32_t current_x,
+                        std::int32_t current_y, std::int32_t width,
+                        std::int32_t height);
+
+  // Return number of rows and columns shown by the last Render
+  std::uint32_t GetVisibleRows() const { return m_Rows; }
+  std::uint32_t GetVisibleColumns() const { return m_Columns; }
+
+private:
+  // Everything a cell's look depends on
+  struct CellState {
+    CardId card = 0; // Only set for revealed cards
+    bool revealed = false;
+    bool matched = false;
+    bool selected = false;
+
+    bool operator==(const CellState &) const = default;
+  };
+
+  // Build element for a single cell
+  ftxui::Element CreateCell(const CellState &state) const;
+
+  // Move the first visible row or column as little as possible so that
+  // current lies in the count visible ones
+  static std::uint32_t Scroll(std::uint32_t first, std::int32_t current,
+                              std::uint32_t count, std::uint32_t board_size);
+
+  std::uint32_t m_BoardSize = 0; // Board size the cache was built for
+
+  std::uint32_t m_CellWidth = 0;  // Width of a cell, border included
+  std::uint32_t m_CellHeight = 0; // Height of a cell, border included
+
+  std::uint32_t m_Top = 0;     // First visible row
+  std::uint32_t m_Left = 0;    // First visible column
+  std::uint32_t m_Rows = 0;    // Number of visible rows
+  std::uint32_t m_Columns = 0; // Number of visible columns
+
+  // Cached state per visible cell, row * m_Columns + column
+  std::vector<CellState> m_States{};
+
+  std::vector<ftxui::Elements> m_Cells{}; // Cached element per visible cell
+
+  ftxui::Element m_Board{}; // Cached view, null if any cell changed
+};
+
+} // namespace memory_game
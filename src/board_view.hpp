@@ -0,0 +1,117 @@
+#pragma once
+
+// local
+#include <dynamic_packed_bool_array.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+
+namespace memory_game {
+
+// Size of a cache line. Board buffers are aligned to it so a whole small board
+// is fetched in as few lines as possible.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// Minimal allocator handing out cache line aligned memory from a
+// std::pmr::memory_resource (the default resource unless one is given). Like
+// std::pmr::polymorphic_allocator, copies of a container use the default
+// resource and moves keep the source's.
+template <typename T> struct CacheAlignedAllocator {
+  using value_type = T;
+
+  CacheAlignedAllocator() = default;
+
+  CacheAlignedAllocator(std::pmr::memory_resource *resource) noexcept
+      : m_Resource(resource) {}
+
+  template <typename U>
+  constexpr CacheAlignedAllocator(const CacheAlignedAllocator<U> &other) noexcept
+      : m_Resource(other.m_Resource) {}
+
+  T *allocate(const std::size_t count) {
+    return static_cast<T *>(
+        m_Resource->allocate(count * sizeof(T), kCacheLineSize));
+  }
+
+  void deallocate(T *ptr, const std::size_t count) noexcept {
+    m_Resource->deallocate(ptr, count * sizeof(T), kCacheLineSize);
+  }
+
+  CacheAlignedAllocator select_on_container_copy_construction() const {
+    return {};
+  }
+
+  template <typename U>
+  bool operator==(const CacheAlignedAllocator<U> &other) const noexcept {
+    return *m_Resource == *other.m_Resource;
+  }
+
+  std::pmr::memory_resource *m_Resource = std::pmr::get_default_resource();
+};
+
+// Non-owning 2D view over a contiguous size x size buffer indexed by
+// x * size + y. Allows `view[x][y]` like the old vector of vectors.
+template <typename T> class BoardView {
+public:
+  BoardView(const T *data, const std::uint32_t size)
+      : m_Data(data), m_Size(size) {}
+
+  // Return row x
+  std::span<const T> operator[](const std::size_t x) const {
+    return {m_Data + x * m_Size, m_Size};
+  }
+
+  // Return pointer to the first element
+  const T *data() const { return m_Data; }
+
+  // Return number of rows (and columns)
+  std::uint32_t size() const { return m_Size; }
+
+private:
+  const T *m_Data;      // Start of the contiguous buffer
+  std::uint32_t m_Size; // Width and height of the board
+};
+
+// Non-owning 2D view over a DynamicPackedBoolArray storing a size x size
+// bit mask indexed by x * size + y
+class PackedBoolBoardView {
+public:
+  // Single row of the mask
+  class Row {
+  public:
+    Row(const DynamicPackedBoolArray *array, const std::size_t offset)
+        : m_Array(array), m_Offset(offset) {}
+
+    bool operator[](const std::size_t y) const {
+      return m_Array->Test(m_Offset + y);
+    }
+
+  private:
+    const DynamicPackedBoolArray *m_Array;
+    std::size_t m_Offset; // Bit index of the first cell in the row
+  };
+
+  PackedBoolBoardView(const DynamicPackedBoolArray &array,
+                      const std::uint32_t size)
+      : m_Array(&array), m_Size(size) {}
+
+  // Return row x
+  Row operator[](const std::size_t x) const {
+    return Row(m_Array, x * m_Size);
+  }
+
+  // Return number of rows (and columns)
+  std::uint32_t size() const { return m_Size; }
+
+  // Return underlying mask for whole-board queries
+  const DynamicPackedBoolArray &bits() const { return *m_Array; }
+
+private:
+  const DynamicPackedBoolArray *m_Array;
+  std::uint32_t m_Size; // Width and height of the board
+};
+
+} // namespace memory_game
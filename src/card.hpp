@@ -0,0 +1,59 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace memory_game {
+
+// Face of a card. Both cards of pair n have id n, so boards of any size are
+// dealt and compared in O(1) per card.
+using CardId = std::uint32_t;
+
+// Symbols cards are shown with: ids 0..61 get one character, later ids two,
+// then three and so on (bijective base 62)
+inline constexpr std::string_view kCardAlphabet =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+// Display symbol of a card, built without allocating
+struct CardSymbol {
+  char text[7];            // Longest symbol of a 32 bit id is 6 characters
+  std::uint8_t length = 0; // Characters used in text
+
+  std::string_view view() const { return {text, length}; }
+};
+
+// Return display symbol of card id
+constexpr CardSymbol GetCardSymbol(CardId id) {
+  CardSymbol symbol{};
+
+  // Digits come out least significant first
+  std::uint64_t value = id;
+  do {
+    symbol.text[symbol.length++] = kCardAlphabet[value % kCardAlphabet.size()];
+    value = value / kCardAlphabet.size();
+  } while (value-- != 0);
+
+  for (std::size_t i = 0; i < symbol.length / 2u; i++) {
+    const char c = symbol.text[i];
+    symbol.text[i] = symbol.text[symbol.length - 1 - i];
+    symbol.text[symbol.length - 1 - i] = c;
+  }
+
+  return symbol;
+}
+
+// Return bytes needed to store every card id of a board with pair_count
+// pairs: 1, 2 or 4
+constexpr std::uint32_t GetCardWidth(std::uint64_t pair_count) {
+  if (pair_count <= (1u << 8)) {
+    return 1;
+  }
+  if (pair_count <= (1u << 16)) {
+    return 2;
+  }
+  return 4;
+}
+
+} // namespace memory_game
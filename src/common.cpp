@@ -2,13 +2,169 @@
 #include "common.hpp"
 
 // std
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
 #include <ctime>
+#include <fstream>
+#include <system_error>
 
-std::filesystem::path get_timestamp_filename() {
-  auto now = std::chrono::system_clock::now();
-  std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-  std::string timestamp = std::to_string(now_c);
-  return timestamp + ".dat";
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Temporary files of this process made so far
+std::atomic<std::uint64_t> g_TempFileCount{0};
+
+// Return a temporary file name next to filename, unique to this process and
+// call so concurrent writers of the same file never share one
+std::filesystem::path
+get_temp_filename(const std::filesystem::path &filename) {
+#ifdef _WIN32
+  const auto process = static_cast<std::uint64_t>(GetCurrentProcessId());
+#else
+  const auto process = static_cast<std::uint64_t>(getpid());
+#endif
+
+  std::filesystem::path temp_filename = filename;
+  temp_filename += "." + std::to_string(process) + "-" +
+                   std::to_string(g_TempFileCount.fetch_add(1)) + ".tmp";
+  return temp_filename;
+}
+
+#ifdef _WIN32
+
+// Create temp_filename, which must not exist, write data to it and flush it
+// to disk
+bool write_new_file_synced(const std::filesystem::path &temp_filename,
+                           std::span<const std::byte> data) {
+  HANDLE file = CreateFileW(temp_filename.c_str(), GENERIC_WRITE, 0, nullptr,
+                            CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  bool written = true;
+  for (std::size_t offset = 0; written && offset < data.size();) {
+    const auto size = static_cast<DWORD>(
+        std::min<std::size_t>(data.size() - offset, 1u << 30));
+    DWORD chunk = 0;
+    written = WriteFile(file, data.data() + offset, size, &chunk, nullptr) &&
+              chunk > 0;
+    offset += chunk;
+  }
+
+  written = written && FlushFileBuffers(file);
+  CloseHandle(file);
+  return written;
+}
+
+// Directory entries are flushed with the rename on Windows
+bool sync_directory(const std::filesystem::path &) { return true; }
+
+#else
+
+// Create temp_filename, which must not exist, write data to it and flush it
+// to disk
+bool write_new_file_synced(const std::filesystem::path &temp_filename,
+                           std::span<const std::byte> data) {
+  const int fd = open(temp_filename.c_str(),
+                     O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool written = true;
+  for (std::size_t offset = 0; written && offset < data.size();) {
+    const ssize_t result =
+        write(fd, data.data() + offset, data.size() - offset);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+
+    written = result > 0;
+    offset += written ? static_cast<std::size_t>(result) : 0;
+  }
+
+  written = written && fsync(fd) == 0;
+  close(fd);
+  return written;
+}
+
+// Flush the entries of directory, so a rename into it survives a power loss
+bool sync_directory(const std::filesystem::path &directory) {
+  const int fd = open(directory.empty() ? "." : directory.c_str(),
+                      O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  const bool synced = fsync(fd) == 0;
+  close(fd);
+  return synced;
+}
+
+#endif
+
+} // namespace
+
+std::filesystem::path
+get_timestamp_filename(const std::filesystem::path &directory,
+                       std::time_t timestamp) {
+  const std::string stem = std::to_string(timestamp);
+  std::filesystem::path filename = directory / (stem + ".dat");
+
+  // Saving twice in a second must not overwrite the first save
+  std::error_code error{};
+  for (std::uint32_t sequence = 1; std::filesystem::exists(filename, error);
+       sequence++) {
+    filename = directory / (stem + "-" + std::to_string(sequence) + ".dat");
+  }
+
+  return filename;
+}
+
+bool parse_timestamp_filename(const std::filesystem::path &filename,
+                              std::int64_t &timestamp,
+                              std::uint32_t &sequence) {
+  if (filename.extension() != ".dat") {
+    return false;
+  }
+
+  const std::string stem = filename.stem().string();
+  const char *const end = stem.data() + stem.size();
+
+  const auto [time_end, time_ec] = std::from_chars(stem.data(), end, timestamp);
+  if (time_ec != std::errc{}) {
+    return false;
+  }
+
+  sequence = 0;
+  if (time_end == end) {
+    return true;
+  }
+
+  // "-<n>" suffix of a save made in the same second as another
+  if (*time_end != '-') {
+    return false;
+  }
+
+  const auto [sequence_end, sequence_ec] =
+      std::from_chars(time_end + 1, end, sequence);
+
+  return sequence_ec == std::errc{} && sequence_end == end && sequence > 0;
 }
 
 std::string get_human_readable_timestamp(const std::string &filename) {
@@ -53,4 +209,41 @@ void create_dir(const std::filesystem::path &directory) {
     // Create the directory
     (std::filesystem::create_directory(directory));
   }
+}
+
+bool write_file_atomically(const std::filesystem::path &filename,
+                           std::span<const std::byte> data) {
+  const std::filesystem::path temp_filename = get_temp_filename(filename);
+
+  // The data must be on disk before the rename, else a power loss can leave
+  // filename empty or torn
+  std::error_code error{};
+  if (!write_new_file_synced(temp_filename, data)) {
+    std::filesystem::remove(temp_filename, error);
+    return false;
+  }
+
+  std::filesystem::rename(temp_filename, filename, error);
+
+  if (error) {
+    std::filesystem::remove(temp_filename, error);
+    return false;
+  }
+
+  return sync_directory(filename.parent_path());
+}
+
+bool read_file(const std::filesystem::path &filename,
+               std::vector<std::byte> &data) {
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+  if (!file.is_open()) {
+    return false;
+  }
+
+  data.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(data.data()), data.size());
+
+  return static_cast<bool>(file);
 }
\ No newline at end of file
@@ -1,11 +1,37 @@
 #pragma once
 
 // std
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
-std::filesystem::path get_timestamp_filename();
+// Parse the whole of text as a decimal number. Returns false if it's not one
+// or doesn't fit in value.
+template <typename T> bool parse_number(std::string_view text, T &value) {
+  const auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return ec == std::errc{} && end == text.data() + text.size();
+}
+
+// Return path of a new save in directory named after timestamp,
+// "<unix time>.dat", or "<unix time>-<n>.dat" with the smallest n not taken
+// if a save of the same second exists
+std::filesystem::path
+get_timestamp_filename(const std::filesystem::path &directory,
+                       std::time_t timestamp = std::time(nullptr));
+
+// Parse save file name made by get_timestamp_filename. Returns false if it's
+// not one.
+bool parse_timestamp_filename(const std::filesystem::path &filename,
+                              std::int64_t &timestamp,
+                              std::uint32_t &sequence);
 
 std::string get_human_readable_timestamp(const std::string &filename);
 
@@ -16,3 +42,13 @@ std::vector<std::string>
 get_human_readable_file_list(const std::filesystem::path &directory);
 
 void create_dir(const std::filesystem::path &directory);
+
+// Write data to a uniquely named temporary file, flush it to disk and rename
+// it over filename, so filename never holds a partially written file, even
+// after a power loss. Returns false on failure.
+bool write_file_atomically(const std::filesystem::path &filename,
+                           std::span<const std::byte> data);
+
+// Read whole file into data. Returns false on failure.
+bool read_file(const std::filesystem::path &filename,
+               std::vector<std::byte> &data);
\ No newline at end of file
@@ -0,0 +1,68 @@
+// header
+#include "computer_players.hpp"
+
+// std
+#include <utility>
+
+namespace memory_game {
+
+void ComputerPlayers::SetPolicy(std::uint32_t player,
+                                std::unique_ptr<MovePolicy> policy) {
+  if (player >= m_Policies.size()) {
+    m_Policies.resize(player + 1);
+  }
+
+  m_Policies[player] = std::move(policy);
+}
+
+bool ComputerPlayers::IsComputerTurn(const MemoryLogic &logic) const {
+  return logic.GetGameStatus() != GameStatus::gameFinished &&
+         IsComputer(logic.GetCurrentPlayerIndex());
+}
+
+void ComputerPlayers::Reset(const MemoryLogic &logic, std::uint64_t seed) {
+  for (std::size_t i = 0; i < m_Policies.size(); i++) {
+    if (m_Policies[i] != nullptr) {
+      m_Policies[i]->Reset(logic.GetBoardSize(), MixSeed(seed + i + 1));
+    }
+  }
+
+  m_FirstIndex = 0;
+}
+
+void ComputerPlayers::SelectCard(MemoryLogic &logic, std::uint32_t x,
+                                 std::uint32_t y) {
+  const GameStatus status = logic.GetGameStatus();
+
+  logic.SelectCard(x, y);
+
+  // Only a newly turned card is news, hiding shows nothing
+  if (status == GameStatus::cardsDidntMatch ||
+      logic.GetGameStatus() == status) {
+    return;
+  }
+
+  ObserveSelection(logic, m_Policies, status, x * logic.GetBoardSize() + y,
+                   m_FirstIndex);
+}
+
+bool ComputerPlayers::PlayStep(MemoryLogic &logic) {
+  if (!IsComputerTurn(logic)) {
+    return false;
+  }
+
+  if (logic.GetGameStatus() == GameStatus::cardsDidntMatch) {
+    logic.SelectCard(0, 0);
+    return true;
+  }
+
+  const std::uint32_t index =
+      m_Policies[logic.GetCurrentPlayerIndex()]->ChooseCard(logic);
+
+  SelectCard(logic, index / logic.GetBoardSize(),
+             index % logic.GetBoardSize());
+
+  return true;
+}
+
+} // namespace memory_game
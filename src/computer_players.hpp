@@ -0,0 +1,52 @@
+#pragma once
+
+// local
+#include "memory_logic.hpp"
+#include "simulation.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace memory_game {
+
+// Computer opponents at a game played by humans.
+//
+// Each player slot of MemoryLogic is a human or a computer driven by a
+// MovePolicy. All selections go through SelectCard or PlayStep, so the
+// computers see every card turned, like players watching the table. Hiding
+// mismatched cards is up to the player whose turn comes next.
+class ComputerPlayers {
+public:
+  // Make player a computer playing policy, nullptr makes it human again.
+  // Call Reset before the next move.
+  void SetPolicy(std::uint32_t player, std::unique_ptr<MovePolicy> policy);
+
+  // Return whether player is a computer
+  bool IsComputer(std::uint32_t player) const {
+    return player < m_Policies.size() && m_Policies[player] != nullptr;
+  }
+
+  // Return whether a computer is to move in an unfinished game
+  bool IsComputerTurn(const MemoryLogic &logic) const;
+
+  // Forget every card seen. Call after a board was dealt or loaded.
+  void Reset(const MemoryLogic &logic, std::uint64_t seed);
+
+  // Select card x, y in logic for the player to move and show it to the
+  // computers
+  void SelectCard(MemoryLogic &logic, std::uint32_t x, std::uint32_t y);
+
+  // Play one step of the computer to move: hide mismatched cards or select
+  // one card. Returns false if no computer is to move.
+  bool PlayStep(MemoryLogic &logic);
+
+private:
+  // Policy per player, nullptr for humans
+  std::vector<std::unique_ptr<MovePolicy>> m_Policies{};
+
+  std::uint32_t m_FirstIndex = 0; // First card of the current turn
+};
+
+} // namespace memory_game
@@ -0,0 +1,290 @@
+// header
+#include "dynamic_packed_bool_array.hpp"
+
+// std
+#include <bit>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PACKED_BITS_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PACKED_BITS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace packed_bits {
+
+namespace {
+
+/* Scalar kernels, one word at a time */
+
+std::size_t CountScalar(const std::uint64_t *words, const std::size_t size) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    count += std::popcount(words[i]);
+  }
+  return count;
+}
+
+void AndScalar(std::uint64_t *dst, const std::uint64_t *src,
+               const std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) {
+    dst[i] &= src[i];
+  }
+}
+
+void OrScalar(std::uint64_t *dst, const std::uint64_t *src,
+              const std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) {
+    dst[i] |= src[i];
+  }
+}
+
+void AndNotScalar(std::uint64_t *dst, const std::uint64_t *src,
+                  const std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) {
+    dst[i] &= ~src[i];
+  }
+}
+
+std::size_t FindNonZeroScalar(const std::uint64_t *words,
+                              const std::size_t size) {
+  std::size_t i = 0;
+  while (i < size && words[i] == 0) {
+    i++;
+  }
+  return i;
+}
+
+std::size_t FindNonFullScalar(const std::uint64_t *words,
+                              const std::size_t size) {
+  std::size_t i = 0;
+  while (i < size && words[i] == ~std::uint64_t{0}) {
+    i++;
+  }
+  return i;
+}
+
+constexpr Kernels kScalarKernels{
+    CountScalar,       AndScalar,         OrScalar, AndNotScalar,
+    FindNonZeroScalar, FindNonFullScalar, "scalar"};
+
+#ifdef PACKED_BITS_AVX2
+
+/* AVX2 kernels, four words at a time. Compiled for AVX2 regardless of the
+ * build flags and only called after checking the CPU supports it. */
+
+#define PACKED_BITS_TARGET __attribute__((target("avx2,popcnt")))
+
+// Nibble lookup popcount (Mula et al.), summed per 64-bit lane by vpsadbw
+PACKED_BITS_TARGET std::size_t CountAvx2(const std::uint64_t *words,
+                                         const std::size_t size) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                       1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0F);
+
+  __m256i total = _mm256_setzero_si256();
+
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+    const __m256i low = _mm256_and_si256(v, low_mask);
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low),
+                                          _mm256_shuffle_epi8(lookup, high));
+    total = _mm256_add_epi64(total,
+                             _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+
+  alignas(32) std::uint64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), total);
+
+  std::size_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < size; i++) {
+    count += _mm_popcnt_u64(words[i]);
+  }
+  return count;
+}
+
+PACKED_BITS_TARGET void AndAvx2(std::uint64_t *dst, const std::uint64_t *src,
+                                const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    auto *d = reinterpret_cast<__m256i *>(dst + i);
+    const auto *s = reinterpret_cast<const __m256i *>(src + i);
+    _mm256_storeu_si256(
+        d, _mm256_and_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+  }
+  AndScalar(dst + i, src + i, size - i);
+}
+
+PACKED_BITS_TARGET void OrAvx2(std::uint64_t *dst, const std::uint64_t *src,
+                               const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    auto *d = reinterpret_cast<__m256i *>(dst + i);
+    const auto *s = reinterpret_cast<const __m256i *>(src + i);
+    _mm256_storeu_si256(
+        d, _mm256_or_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+  }
+  OrScalar(dst + i, src + i, size - i);
+}
+
+PACKED_BITS_TARGET void AndNotAvx2(std::uint64_t *dst,
+                                   const std::uint64_t *src,
+                                   const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    auto *d = reinterpret_cast<__m256i *>(dst + i);
+    const auto *s = reinterpret_cast<const __m256i *>(src + i);
+    // vpandn negates its first operand
+    _mm256_storeu_si256(
+        d, _mm256_andnot_si256(_mm256_loadu_si256(s), _mm256_loadu_si256(d)));
+  }
+  AndNotScalar(dst + i, src + i, size - i);
+}
+
+// Skip whole vectors of zero words with vptest
+PACKED_BITS_TARGET std::size_t FindNonZeroAvx2(const std::uint64_t *words,
+                                               const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+    if (!_mm256_testz_si256(v, v)) {
+      break;
+    }
+  }
+
+  return i + FindNonZeroScalar(words + i, size - i);
+}
+
+// Skip whole vectors of all-ones words with vptest
+PACKED_BITS_TARGET std::size_t FindNonFullAvx2(const std::uint64_t *words,
+                                               const std::size_t size) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+    if (!_mm256_testc_si256(v, ones)) {
+      break;
+    }
+  }
+
+  return i + FindNonFullScalar(words + i, size - i);
+}
+
+#undef PACKED_BITS_TARGET
+
+constexpr Kernels kAvx2Kernels{CountAvx2,       AndAvx2,         OrAvx2,
+                               AndNotAvx2,      FindNonZeroAvx2, FindNonFullAvx2,
+                               "avx2"};
+
+#endif
+
+#ifdef PACKED_BITS_NEON
+
+/* NEON kernels, two words at a time. NEON is always present on AArch64. */
+
+std::size_t CountNeon(const std::uint64_t *words, const std::size_t size) {
+  uint64x2_t total = vdupq_n_u64(0);
+
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const uint8x16_t bytes =
+        vcntq_u8(vreinterpretq_u8_u64(vld1q_u64(words + i)));
+    total = vpadalq_u32(total, vpaddlq_u16(vpaddlq_u8(bytes)));
+  }
+
+  std::size_t count = vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1);
+  for (; i < size; i++) {
+    count += std::popcount(words[i]);
+  }
+  return count;
+}
+
+void AndNeon(std::uint64_t *dst, const std::uint64_t *src,
+             const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    vst1q_u64(dst + i, vandq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+  }
+  AndScalar(dst + i, src + i, size - i);
+}
+
+void OrNeon(std::uint64_t *dst, const std::uint64_t *src,
+            const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    vst1q_u64(dst + i, vorrq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+  }
+  OrScalar(dst + i, src + i, size - i);
+}
+
+void AndNotNeon(std::uint64_t *dst, const std::uint64_t *src,
+                const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    // vbic clears the bits set in its second operand
+    vst1q_u64(dst + i, vbicq_u64(vld1q_u64(dst + i), vld1q_u64(src + i)));
+  }
+  AndNotScalar(dst + i, src + i, size - i);
+}
+
+std::size_t FindNonZeroNeon(const std::uint64_t *words,
+                            const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const uint64x2_t v = vld1q_u64(words + i);
+    if ((vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) != 0) {
+      break;
+    }
+  }
+
+  return i + FindNonZeroScalar(words + i, size - i);
+}
+
+std::size_t FindNonFullNeon(const std::uint64_t *words,
+                            const std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const uint64x2_t v = vld1q_u64(words + i);
+    if ((vgetq_lane_u64(v, 0) & vgetq_lane_u64(v, 1)) != ~std::uint64_t{0}) {
+      break;
+    }
+  }
+
+  return i + FindNonFullScalar(words + i, size - i);
+}
+
+constexpr Kernels kNeonKernels{CountNeon,       AndNeon,         OrNeon,
+                               AndNotNeon,      FindNonZeroNeon, FindNonFullNeon,
+                               "neon"};
+
+#endif
+
+// Pick the fastest kernels the running CPU supports
+const Kernels &SelectKernels() {
+#if defined(PACKED_BITS_AVX2)
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+    return kAvx2Kernels;
+  }
+#elif defined(PACKED_BITS_NEON)
+  return kNeonKernels;
+#endif
+
+  return kScalarKernels;
+}
+
+} // namespace
+
+const Kernels &GetKernels() {
+  static const Kernels &kernels = SelectKernels();
+  return kernels;
+}
+
+} // namespace packed_bits
@@ -22,140 +22,468 @@
  * Actually the memory savings are at the cost of more overhead to write and
  * read data.
  *
+ * Q: How is it stored?
+ * A: As a bitboard of 64-bit words. Bit `index` lives in word `index / 64` at
+ * position `index % 64`, so whole-array questions like "how many bits are set"
+ * are one popcount per word, and setting a bit is a couple of ALU ops without
+ * a branch on the value.
+ *
+ * Q: What about whole-array operations?
+ * A: Counting, searching and AND/OR/ANDNOT work on whole words. Arrays longer
+ * than a few words go through kernels picked once at runtime for the CPU
+ * (AVX2 on x86-64, NEON on AArch64, plain words otherwise). Bits past the end
+ * of the last word are ignored by every read, so they never need clearing.
+ *
+ * Q: Where does the memory come from?
+ * A: Arrays of up to 128 bits (boards up to 11x11) live inside the object, so
+ * they never allocate. Larger arrays use a cache line aligned heap buffer
+ * that is kept when the array shrinks or is cleared, so resetting boards in a
+ * loop reuses it. The array owns its buffer and can be copied and moved.
+ * The heap buffer comes from a std::pmr::memory_resource, so a game's masks
+ * can live in the same arena as the rest of its state.
+ *
  */
 
 #pragma once
 
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <memory_resource>
 #include <stdexcept>
+#include <utility>
+
+namespace packed_bits {
+
+// Bulk word kernels. Sizes are in 64-bit words.
+struct Kernels {
+  // Count set bits
+  std::size_t (*count)(const std::uint64_t *words, std::size_t size);
+
+  // dst = dst & src
+  void (*and_words)(std::uint64_t *dst, const std::uint64_t *src,
+                    std::size_t size);
+
+  // dst = dst | src
+  void (*or_words)(std::uint64_t *dst, const std::uint64_t *src,
+                   std::size_t size);
+
+  // dst = dst & ~src
+  void (*and_not_words)(std::uint64_t *dst, const std::uint64_t *src,
+                        std::size_t size);
+
+  // Return index of the first word that isn't 0, or size
+  std::size_t (*find_non_zero)(const std::uint64_t *words, std::size_t size);
+
+  // Return index of the first word that isn't all ones, or size
+  std::size_t (*find_non_full)(const std::uint64_t *words, std::size_t size);
+
+  const char *name; // "avx2", "neon" or "scalar"
+};
+
+// Return the fastest kernels supported by the running CPU
+const Kernels &GetKernels();
+
+} // namespace packed_bits
 
 // Proxy class to allow for setting bit value through [] operator
 class Proxy {
 public:
-  Proxy(std::uint8_t *byte, std::size_t bit_position)
-      : m_Byte(byte), m_BitPosition(bit_position) {}
+  Proxy(std::uint64_t *word, std::size_t bit_position)
+      : m_Word(word), m_BitPosition(bit_position) {}
 
   // Conversion operator to bool
-  operator bool() const { return (*m_Byte & (1 << m_BitPosition)) != 0; }
+  operator bool() const { return (*m_Word >> m_BitPosition) & 1; }
 
   // Assignment operator to set the bit
   Proxy &operator=(const bool value) {
-    if (value) {
-      *m_Byte |= (1 << m_BitPosition);
-    } else {
-      *m_Byte &= ~(1 << m_BitPosition);
-    }
+    const std::uint64_t bitmask = std::uint64_t{1} << m_BitPosition;
+    *m_Word = (*m_Word & ~bitmask) | (-std::uint64_t{value} & bitmask);
     return *this;
   }
 
 private:
-  std::uint8_t *m_Byte;
+  std::uint64_t *m_Word;
   std::size_t m_BitPosition;
 };
 
 class DynamicPackedBoolArray {
 public:
-  DynamicPackedBoolArray() : m_Data(nullptr), m_SizeInBits(0) {}
+  // Empty array using the inline buffer
+  DynamicPackedBoolArray() = default;
 
-  // Allocate memory and initialize to 0
-  DynamicPackedBoolArray(const std::size_t size_in_bits)
-      : m_SizeInBits(size_in_bits) {
-    m_Data = reinterpret_cast<std::uint8_t *>(std::calloc(1, GetSizeInBytes()));
+  // Empty array whose heap buffer comes from resource
+  explicit DynamicPackedBoolArray(std::pmr::memory_resource *resource)
+      : m_Resource(resource) {}
+
+  // Array of size_in_bits bits, all 0
+  DynamicPackedBoolArray(const std::size_t size_in_bits,
+                         std::pmr::memory_resource *resource =
+                             std::pmr::get_default_resource())
+      : m_Resource(resource) {
+    Resize(size_in_bits);
+  }
+
+  // Copy only the words in use. The copy gets just the capacity it needs and,
+  // like std::pmr containers, uses the default resource.
+  DynamicPackedBoolArray(const DynamicPackedBoolArray &other) {
+    *this = other;
+  }
+
+  // Steal the heap buffer and its resource, or copy the inline words
+  DynamicPackedBoolArray(DynamicPackedBoolArray &&other) noexcept
+      : m_Resource(other.m_Resource) {
+    *this = std::move(other);
   }
 
-  // Free the data. I don't have to worry about dangling pointer since the
-  // m_Data pointer goes out of scope anyway.
-  ~DynamicPackedBoolArray() { free(m_Data); }
+  // Copy into the existing buffer, growing it only if it's too small
+  DynamicPackedBoolArray &operator=(const DynamicPackedBoolArray &other) {
+    if (this != &other) {
+      Reserve(other.m_SizeInBits);
+      m_SizeInBits = other.m_SizeInBits;
+      std::memcpy(m_Data, other.m_Data, other.GetSizeInBytes());
+    }
 
-  // Resize the data. Using calloc instead of realloc since I don't want to copy
-  // the data.
+    return *this;
+  }
+
+  // Steal the heap buffer if both arrays share a resource, otherwise copy
+  DynamicPackedBoolArray &operator=(DynamicPackedBoolArray &&other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    if (other.IsInline()) {
+      // Nothing to steal, the words fit in our buffer whatever it is
+      std::memcpy(m_Data, other.m_Data, other.GetSizeInBytes());
+    } else if (*m_Resource != *other.m_Resource) {
+      // Memory from another resource can't be freed by ours
+      Reserve(other.m_SizeInBits);
+      std::memcpy(m_Data, other.m_Data, other.GetSizeInBytes());
+    } else {
+      Deallocate(m_Data, m_CapacityInWords);
+      m_Data = std::exchange(other.m_Data, other.m_Inline);
+      m_CapacityInWords =
+          std::exchange(other.m_CapacityInWords, kInlineWords);
+    }
+
+    m_SizeInBits = std::exchange(other.m_SizeInBits, 0);
+    return *this;
+  }
+
+  // Free the heap buffer, if there is one
+  ~DynamicPackedBoolArray() { Deallocate(m_Data, m_CapacityInWords); }
+
+  // Resize the array. Bits that become part of the array are 0, bits that
+  // were already in it keep their values. Memory is only allocated when the
+  // capacity is exceeded and never released, so resetting boards of the same
+  // or smaller size doesn't touch the allocator.
   void Resize(const std::size_t size_in_bits) {
-    // Allocate memory only if the requested size in bytes is larger than
-    // currently allocated bytes
-    if (BitsToBytes(size_in_bits) > GetSizeInBytes()) {
-      m_Data = reinterpret_cast<std::uint8_t *>(
-          std::calloc(1, BitsToBytes(size_in_bits)));
+    Reserve(size_in_bits);
+
+    if (size_in_bits > m_SizeInBits) {
+      ClearBits(m_SizeInBits, size_in_bits);
     }
 
     m_SizeInBits = size_in_bits;
   }
 
-  // Clear the array. Don't free the memory since its costly and it will be done
-  // in dtor anyway.
+  // Make room for size_in_bits bits without changing the size
+  void Reserve(const std::size_t size_in_bits) {
+    const std::size_t words = BitsToWords(size_in_bits);
+    if (words <= m_CapacityInWords) {
+      return;
+    }
+
+    const std::size_t capacity = RoundUpToCacheLine(words);
+    std::uint64_t *data = Allocate(capacity);
+    std::memcpy(data, m_Data, GetSizeInBytes());
+
+    Deallocate(m_Data, m_CapacityInWords);
+    m_Data = data;
+    m_CapacityInWords = capacity;
+  }
+
+  // Clear the array. Keeps the memory for the next Resize.
   void Clear() { m_SizeInBits = 0; }
 
   // Set bit at position index to val
   void Set(const std::size_t index, const bool val) {
     if (index < m_SizeInBits) {
-      std::uint8_t *byte = GetBytePtr(index);
-
-      if (val) {
-        *byte = *byte | (1 << (index % 8));
-      } else {
-        *byte = *byte & ~(1 << (index % 8));
-      }
+      SetUnchecked(index, val);
     }
   }
 
-  // Set m_Data to some other pointer of size size_in_bits
-  void SetArray(std::uint8_t *ptr, const std::size_t size_in_bits) {
-    m_SizeInBits = size_in_bits;
-
-    m_Data = ptr;
+  // Set bit at position index to val without bounds checking. Branch free.
+  void SetUnchecked(const std::size_t index, const bool val) {
+    std::uint64_t &word = m_Data[index / 64];
+    const std::uint64_t bitmask = std::uint64_t{1} << (index % 64);
+    word = (word & ~bitmask) | (-std::uint64_t{val} & bitmask);
   }
 
-  // Set all of the bytes to 0
+  // Set all of the words to 0
   void SetToZero() {
-    for (std::size_t i = 0; i < GetSizeInBytes(); i++) {
-      *(m_Data + i) = 0;
+    if (m_Data != nullptr) {
+      std::memset(m_Data, 0, GetSizeInBytes());
     }
   }
 
   // Get bit value at position index
   bool GetBit(const std::size_t index) const {
-    if (index > m_SizeInBits) {
+    if (index >= m_SizeInBits) {
       throw std::out_of_range("Index out of range");
     }
 
-    std::uint8_t bitmask = 1 << (index % 8);
-    std::uint8_t byte = *GetBytePtr(index);
-    return (byte & bitmask) != 0;
+    return Test(index);
+  }
+
+  // Get bit value at position index without bounds checking
+  bool Test(const std::size_t index) const {
+    return (m_Data[index / 64] >> (index % 64)) & 1;
+  }
+
+  // Count set bits
+  std::size_t Count() const {
+    const std::size_t full_words = m_SizeInBits / 64;
+
+    std::size_t count = 0;
+    if (full_words < kBulkWords) {
+      for (std::size_t i = 0; i < full_words; i++) {
+        count += std::popcount(m_Data[i]);
+      }
+    } else {
+      count = packed_bits::GetKernels().count(m_Data, full_words);
+    }
+
+    // Ignore stale bits past the end left over from a larger size
+    if (full_words != GetSizeInWords()) {
+      count += std::popcount(LoadWord(full_words, 0));
+    }
+
+    return count;
+  }
+
+  // Count unset bits
+  std::size_t CountUnset() const { return m_SizeInBits - Count(); }
+
+  // Check whether every bit is set
+  bool All() const { return FindFirstUnset() == kNotFound; }
+
+  // Check whether any bit is set
+  bool Any() const { return FindFirstSet() != kNotFound; }
+
+  // Check whether no bit is set
+  bool None() const { return !Any(); }
+
+  // Return index of the first set bit at or after start, or kNotFound
+  std::size_t FindFirstSet(const std::size_t start = 0) const {
+    return Find(start, 0);
   }
 
-  // Get pointer to the byte that stores bit at position index
-  std::uint8_t *GetBytePtr(const std::size_t index) const {
-    if (index > m_SizeInBits) {
+  // Return index of the first unset bit at or after start, or kNotFound
+  std::size_t FindFirstUnset(const std::size_t start = 0) const {
+    return Find(start, ~std::uint64_t{0});
+  }
+
+  // Call f(index) for every set bit, in increasing order
+  template <typename F> void ForEachSet(F &&f) const { ForEach(f, 0); }
+
+  // Call f(index) for every unset bit, in increasing order
+  template <typename F> void ForEachUnset(F &&f) const {
+    ForEach(f, ~std::uint64_t{0});
+  }
+
+  // this = this & other. Sizes must match.
+  void And(const DynamicPackedBoolArray &other) {
+    CheckSameSize(other);
+    packed_bits::GetKernels().and_words(m_Data, other.m_Data,
+                                        GetSizeInWords());
+  }
+
+  // this = this | other. Sizes must match.
+  void Or(const DynamicPackedBoolArray &other) {
+    CheckSameSize(other);
+    packed_bits::GetKernels().or_words(m_Data, other.m_Data, GetSizeInWords());
+  }
+
+  // this = this & ~other. Sizes must match.
+  void AndNot(const DynamicPackedBoolArray &other) {
+    CheckSameSize(other);
+    packed_bits::GetKernels().and_not_words(m_Data, other.m_Data,
+                                            GetSizeInWords());
+  }
+
+  // Get pointer to the word that stores bit at position index
+  std::uint64_t *GetWordPtr(const std::size_t index) const {
+    if (index >= m_SizeInBits) {
       throw std::out_of_range("Index out of range");
     }
 
-    std::size_t byte_index = index / 8;
-    return m_Data + byte_index;
+    return m_Data + index / 64;
   }
 
   // Get pointer to the m_Data
-  std::uint8_t *GetPtr() const { return m_Data; }
+  std::uint64_t *GetPtr() const { return m_Data; }
+
+  // Get size of the array in bits
+  std::size_t GetSizeInBits() const { return m_SizeInBits; }
 
-  // Get size of m_Data in bytes
-  std::size_t GetSizeInBytes() const { return (m_SizeInBits + 7) / 8; }
+  // Get size of m_Data in 64-bit words
+  std::size_t GetSizeInWords() const { return BitsToWords(m_SizeInBits); }
+
+  // Get size of m_Data in bytes (whole words)
+  std::size_t GetSizeInBytes() const {
+    return GetSizeInWords() * sizeof(std::uint64_t);
+  }
 
   // Overload [] operator to access bit at position index
   bool operator[](const std::size_t index) const { return GetBit(index); }
 
   // Overload [] operator to return a Proxy for setting bits
   Proxy operator[](const std::size_t index) {
-    return Proxy(GetBytePtr(index), index % 8);
+    return Proxy(GetWordPtr(index), index % 64);
   }
 
+  // Returned by the Find functions when there is no such bit
+  static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+
 private:
-  std::size_t BitsToBytes(const std::size_t size_in_bits) const {
-    return (size_in_bits + 7) / 8;
+  // Arrays with fewer words than this are handled inline, without calling
+  // into the bulk kernels
+  static constexpr std::size_t kBulkWords = 4;
+
+  // Return word i xor flip, with bits past the end cleared
+  std::uint64_t LoadWord(const std::size_t i, const std::uint64_t flip) const {
+    const std::uint64_t word = m_Data[i] ^ flip;
+
+    if (const std::size_t tail = m_SizeInBits % 64;
+        tail != 0 && i == m_SizeInBits / 64) {
+      return word & ((std::uint64_t{1} << tail) - 1);
+    }
+
+    return word;
+  }
+
+  // Return index of the first bit at or after start that differs from the
+  // bits of flip (0 finds set bits, all ones finds unset bits)
+  std::size_t Find(const std::size_t start, const std::uint64_t flip) const {
+    if (start >= m_SizeInBits) {
+      return kNotFound;
+    }
+
+    const std::size_t words = GetSizeInWords();
+    std::size_t i = start / 64;
+    std::uint64_t word =
+        LoadWord(i, flip) & (~std::uint64_t{0} << (start % 64));
+
+    while (word == 0) {
+      if (++i == words) {
+        return kNotFound;
+      }
+
+      // Skip uninteresting words in bulk
+      if (words - i >= kBulkWords) {
+        const auto &kernels = packed_bits::GetKernels();
+        i += flip == 0 ? kernels.find_non_zero(m_Data + i, words - i)
+                       : kernels.find_non_full(m_Data + i, words - i);
+
+        if (i == words) {
+          return kNotFound;
+        }
+      }
+
+      word = LoadWord(i, flip);
+    }
+
+    return i * 64 + std::countr_zero(word);
+  }
+
+  // Call f(index) for every bit that differs from the bits of flip
+  template <typename F> void ForEach(F &f, const std::uint64_t flip) const {
+    const std::size_t words = GetSizeInWords();
+
+    for (std::size_t i = 0; i < words; i++) {
+      // Pop the lowest bit until the word is empty
+      for (std::uint64_t word = LoadWord(i, flip); word != 0;
+           word &= word - 1) {
+        f(i * 64 + std::countr_zero(word));
+      }
+    }
+  }
+
+  // Throw if other holds a different number of bits
+  void CheckSameSize(const DynamicPackedBoolArray &other) const {
+    if (other.m_SizeInBits != m_SizeInBits) {
+      throw std::invalid_argument("Array sizes don't match");
+    }
+  }
+
+  // Arrays of up to this many words live inside the object
+  static constexpr std::size_t kInlineWords = 2;
+
+  // Heap data is aligned to a cache line so it never straddles more lines
+  // than it has to
+  static constexpr std::size_t kAlignment = 64;
+
+  // Whether the words are in the inline buffer
+  bool IsInline() const { return m_Data == m_Inline; }
+
+  // Clear bits [first, last)
+  void ClearBits(const std::size_t first, const std::size_t last) {
+    std::size_t word = first / 64;
+
+    // Partial first word
+    if (const std::size_t offset = first % 64; offset != 0) {
+      m_Data[word] &= (std::uint64_t{1} << offset) - 1;
+      word++;
+    }
+
+    // Whole words up to and including the last one touched
+    const std::size_t end = BitsToWords(last);
+    if (end > word) {
+      std::memset(m_Data + word, 0, (end - word) * sizeof(std::uint64_t));
+    }
+  }
+
+  // Round words up to whole cache lines
+  static std::size_t RoundUpToCacheLine(const std::size_t size_in_words) {
+    constexpr std::size_t words_per_line = kAlignment / sizeof(std::uint64_t);
+    return (size_in_words + words_per_line - 1) / words_per_line *
+           words_per_line;
+  }
+
+  // Allocate cache line aligned memory for size_in_words words
+  std::uint64_t *Allocate(const std::size_t size_in_words) const {
+    return static_cast<std::uint64_t *>(m_Resource->allocate(
+        size_in_words * sizeof(std::uint64_t), kAlignment));
   }
 
-  std::uint8_t
-      *m_Data; // Array that stores the boolean, 1-bit size, 1 or 0 values
+  // Free memory returned by Allocate. The inline buffer is left alone.
+  void Deallocate(std::uint64_t *data, const std::size_t size_in_words) const {
+    if (data != m_Inline) {
+      m_Resource->deallocate(data, size_in_words * sizeof(std::uint64_t),
+                             kAlignment);
+    }
+  }
+
+  static std::size_t BitsToWords(const std::size_t size_in_bits) {
+    return (size_in_bits + 63) / 64;
+  }
+
+  // Inline storage for small arrays, up to 128 bits
+  alignas(16) std::uint64_t m_Inline[kInlineWords] = {};
+
+  std::uint64_t *m_Data =
+      m_Inline; // Array of words that stores the boolean, 1-bit size, 1 or 0
+                // values. Points to m_Inline or to the heap.
+
+  std::size_t m_SizeInBits = 0; // Size of the array in bits. (How many boolean
+                                // values it stores)
+
+  std::size_t m_CapacityInWords = kInlineWords; // Words available at m_Data
 
-  std::size_t m_SizeInBits; // Size of the array in bits. (How many boolean
-                            // values it stores)
+  std::pmr::memory_resource *m_Resource =
+      std::pmr::get_default_resource(); // Source of the heap buffer
 };
@@ -0,0 +1,117 @@
+/*
+ *
+ * Small and fast random number generation for the game engine.
+ *
+ * Q: Why not std::mt19937 seeded from std::random_device?
+ * A: Reading std::random_device can be a syscall and seeding the Mersenne
+ * Twister fills 2.5 KB of state. Doing that for every new board costs way more
+ * than shuffling a 10x10 board. xoshiro256++ has 32 bytes of state, seeds in a
+ * few nanoseconds and is more than good enough for shuffling cards.
+ *
+ */
+
+#pragma once
+
+// std
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <utility>
+
+namespace memory_game {
+
+// Mix value into a well distributed 64-bit value (SplitMix64). Used to seed
+// generators and to derive independent seeds from one base seed.
+constexpr std::uint64_t MixSeed(std::uint64_t value) {
+  value += 0x9e3779b97f4a7c15;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+// Return a new unpredictable seed. std::random_device is read once per
+// process, later seeds are derived from it, so creating many games doesn't
+// pay for a hardware read each time.
+inline std::uint64_t FreshSeed() {
+  static const std::uint64_t base =
+      (std::uint64_t{std::random_device{}()} << 32) | std::random_device{}();
+  static std::atomic<std::uint64_t> counter{0};
+
+  return MixSeed(base + counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+// xoshiro256++ generator, satisfies UniformRandomBitGenerator
+class Xoshiro256PlusPlus {
+public:
+  using result_type = std::uint64_t;
+
+  explicit Xoshiro256PlusPlus(const std::uint64_t seed = 0) { Seed(seed); }
+
+  // Reset state deterministically from seed
+  void Seed(std::uint64_t seed) {
+    for (auto &word : m_State) {
+      seed += 0x9e3779b97f4a7c15;
+      word = MixSeed(seed);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  // Return next random value
+  result_type operator()() {
+    const std::uint64_t result =
+        std::rotl(m_State[0] + m_State[3], 23) + m_State[0];
+    const std::uint64_t t = m_State[1] << 17;
+
+    m_State[2] ^= m_State[0];
+    m_State[3] ^= m_State[1];
+    m_State[1] ^= m_State[2];
+    m_State[0] ^= m_State[3];
+
+    m_State[2] ^= t;
+    m_State[3] = std::rotl(m_State[3], 45);
+
+    return result;
+  }
+
+private:
+  std::uint64_t m_State[4]{};
+};
+
+// Return uniformly distributed value in [0, bound). Lemire's multiply and
+// reject method, usually without any division.
+template <typename Rng>
+std::uint32_t UniformBelow(Rng &rng, const std::uint32_t bound) {
+  std::uint64_t product = (rng() >> 32) * bound;
+  std::uint32_t low = static_cast<std::uint32_t>(product);
+
+  if (low < bound) {
+    const std::uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      product = (rng() >> 32) * bound;
+      low = static_cast<std::uint32_t>(product);
+    }
+  }
+
+  return static_cast<std::uint32_t>(product >> 32);
+}
+
+// Fisher-Yates shuffle of [first, last)
+template <typename RandomIt, typename Rng>
+void Shuffle(RandomIt first, RandomIt last, Rng &rng) {
+  const auto count = static_cast<std::uint32_t>(std::distance(first, last));
+
+  for (std::uint32_t i = count; i > 1; i--) {
+    using std::swap;
+    swap(first[i - 1], first[UniformBelow(rng, i)]);
+  }
+}
+
+} // namespace memory_game
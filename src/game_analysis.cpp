@@ -0,0 +1,420 @@
+// header
+#include "game_analysis.hpp"
+
+// local
+#include "fast_rng.hpp"
+#include "optimal_policy.hpp"
+
+// std
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <stdexcept>
+
+namespace memory_game {
+
+namespace {
+
+// State keys: singletons in bits 0..12, player to move in bits 13..15, the
+// pass's own fields from bit 16 on
+constexpr std::uint32_t kPlayerShift = 13;
+constexpr std::uint32_t kFieldsShift = 16;
+constexpr std::uint64_t kSingletonsMask = (std::uint64_t{1} << kPlayerShift) - 1;
+
+// Scores of all players but the last in 12 bits each, the last one follows
+// from the number of matched pairs
+constexpr std::uint32_t kScoreBits = 12;
+constexpr std::uint32_t kMaxScore = (1u << kScoreBits) - 1;
+
+// Chunk of table slots expanded at once
+constexpr std::size_t kChunkSize = 1024;
+
+// Who takes a pair in a turn
+enum class Scorer : std::uint8_t {
+  nobody,
+  mover, // The player whose turn it is
+  next,  // The next player, who takes the pair the mover showed
+};
+
+// One way a turn can end
+struct Outcome {
+  double probability;
+  std::uint32_t unseen;
+  std::uint32_t singletons;
+  Scorer scorer;
+  bool passes; // Whether the turn passes to the next player
+};
+
+// Call visit with every outcome of a turn from unseen, singletons. Known
+// pairs are taken right when they appear, so turns start without them.
+template <typename Visit>
+void ForEachOutcome(AnalysisPolicy policy, const OptimalPlaySolver *solver,
+                    std::uint32_t unseen, std::uint32_t singletons,
+                    Visit &&visit) {
+  const double u = unseen;
+  const double k = singletons;
+
+  std::uint8_t decision = 0;
+  if (policy == AnalysisPolicy::optimal) {
+    decision = solver->GetDecision(unseen, singletons);
+  }
+
+  // A singleton, then an unseen card
+  if ((decision & OptimalPlaySolver::kSingletonFirst) != 0) {
+    visit(Outcome{1.0 / u, unseen - 1, singletons - 1, Scorer::mover, false});
+    if (singletons > 1) {
+      visit(Outcome{(k - 1.0) / u, unseen - 1, singletons - 1, Scorer::next,
+                    true});
+    }
+    if (unseen > singletons) {
+      visit(Outcome{(u - k) / u, unseen - 1, singletons + 1, Scorer::nobody,
+                    true});
+    }
+    return;
+  }
+
+  // An unseen card matching a singleton
+  if (singletons > 0) {
+    visit(Outcome{k / u, unseen - 1, singletons - 1, Scorer::mover, false});
+  }
+
+  if (unseen == singletons) {
+    return;
+  }
+
+  // A new card, then a singleton
+  const double new_card = (u - k) / u;
+  if ((decision & OptimalPlaySolver::kSingletonSecond) != 0) {
+    visit(Outcome{new_card, unseen - 1, singletons + 1, Scorer::nobody, true});
+    return;
+  }
+
+  // A new card, then an unseen card: its partner, a singleton's partner or
+  // another new card
+  const double rest = u - 1.0;
+  visit(Outcome{new_card / rest, unseen - 2, singletons, Scorer::mover,
+                false});
+  if (singletons > 0) {
+    visit(Outcome{new_card * k / rest, unseen - 2, singletons, Scorer::next,
+                  true});
+  }
+  if (unseen - 2 > singletons) {
+    visit(Outcome{new_card * (u - 2.0 - k) / rest, unseen - 2,
+                  singletons + 2, Scorer::nobody, true});
+  }
+}
+
+// Return the player to move and the player scoring after outcome
+std::pair<std::uint32_t, std::uint32_t>
+Players(std::uint32_t player, std::uint32_t player_count,
+        const Outcome &outcome) {
+  const std::uint32_t next = outcome.passes ? (player + 1) % player_count
+                                            : player;
+  return {next, outcome.scorer == Scorer::next ? next : player};
+}
+
+// Pass tracking the scores
+struct WinPass {
+  std::uint32_t cards;
+  std::uint32_t player_count;
+
+  std::uint64_t GetStartKey() const { return 0; }
+
+  // Return number of states layer unseen can hold at most
+  double GetBound(std::uint32_t unseen) const {
+    double bound = 0.0;
+    for (std::uint32_t singletons = unseen % 2;
+         singletons <= std::min(unseen, cards - unseen); singletons += 2) {
+      // Ways to share the matched pairs among the players
+      const std::uint32_t matched = (cards - unseen - singletons) / 2;
+      double ways = 1.0;
+      for (std::uint32_t i = 1; i < player_count; i++) {
+        ways = ways * (matched + i) / i;
+      }
+      bound += player_count * ways;
+    }
+    return bound;
+  }
+
+  std::uint64_t Apply(std::uint64_t key, const Outcome &outcome) const {
+    const auto player =
+        static_cast<std::uint32_t>(key >> kPlayerShift) & 0x7;
+    const auto [next, scorer] = Players(player, player_count, outcome);
+
+    std::uint64_t scores = key >> kFieldsShift;
+    if (outcome.scorer != Scorer::nobody && scorer + 1 < player_count) {
+      scores += std::uint64_t{1} << (kScoreBits * scorer);
+    }
+
+    return outcome.singletons |
+           static_cast<std::uint64_t>(next) << kPlayerShift |
+           scores << kFieldsShift;
+  }
+};
+
+// Pass tracking the turn number
+struct TurnPass {
+  std::uint32_t cards;
+  std::uint32_t player_count;
+
+  std::uint64_t GetStartKey() const {
+    return std::uint64_t{1} << kFieldsShift; // Turn 1
+  }
+
+  double GetBound(std::uint32_t unseen) const {
+    // Every turn that passes showed an unseen card
+    const double turns =
+        static_cast<double>(cards - unseen) / player_count + 2.0;
+    return player_count * turns *
+           ((std::min(unseen, cards - unseen) - unseen % 2) / 2 + 1);
+  }
+
+  std::uint64_t Apply(std::uint64_t key, const Outcome &outcome) const {
+    const auto player =
+        static_cast<std::uint32_t>(key >> kPlayerShift) & 0x7;
+    const std::uint32_t next = Players(player, player_count, outcome).first;
+
+    std::uint64_t turn = key >> kFieldsShift;
+    if (outcome.passes && next == 0) {
+      turn++;
+    }
+
+    return outcome.singletons |
+           static_cast<std::uint64_t>(next) << kPlayerShift |
+           turn << kFieldsShift;
+  }
+};
+
+// Return table with room for bound states
+std::unique_ptr<TranspositionTable> MakeTable(double bound) {
+  const auto states = static_cast<std::size_t>(bound) + 1;
+  return std::make_unique<TranspositionTable>(
+      std::bit_ceil(std::max<std::size_t>(2 * states, 16)));
+}
+
+// Run pass from the start of the game down to unseen 0 and return the table
+// of finished games, or nullptr if it could visit more than max_states
+// states
+template <typename Pass>
+std::unique_ptr<TranspositionTable>
+Propagate(const Pass &pass, const AnalysisConfig &config,
+          const OptimalPlaySolver *solver, WorkStealingPool &pool,
+          std::uint64_t &state_count) {
+  const std::uint32_t cards = pass.cards;
+
+  std::vector<double> bounds(cards + 1);
+  double total = 0.0;
+  for (std::uint32_t unseen = 0; unseen <= cards; unseen++) {
+    bounds[unseen] = pass.GetBound(unseen);
+    total += bounds[unseen];
+    if (total > static_cast<double>(config.max_states)) {
+      return nullptr;
+    }
+  }
+
+  // Only the layer being expanded and the two below it are alive
+  std::vector<std::unique_ptr<TranspositionTable>> layers(cards + 1);
+  layers[cards] = MakeTable(bounds[cards]);
+  layers[cards]->Add(pass.GetStartKey(), 1.0);
+
+  std::vector<std::uint64_t> thread_states(pool.GetThreadCount(), 0);
+
+  for (std::uint32_t unseen = cards; unseen > 0; unseen--) {
+    for (std::uint32_t below = unseen - std::min(unseen, 2u); below < unseen;
+         below++) {
+      if (layers[below] == nullptr) {
+        layers[below] = MakeTable(bounds[below]);
+      }
+    }
+
+    const TranspositionTable &layer = *layers[unseen];
+
+    pool.Run(layer.GetCapacity(), kChunkSize,
+             [&](std::size_t begin, std::size_t end,
+                 std::uint32_t thread_index) {
+               for (std::size_t slot = begin; slot < end; slot++) {
+                 if (!layer.IsUsed(slot)) {
+                   continue;
+                 }
+
+                 const std::uint64_t key = layer.GetKey(slot);
+                 const double probability = layer.GetProbability(slot);
+
+                 ForEachOutcome(
+                     config.policy, solver, unseen,
+                     static_cast<std::uint32_t>(key & kSingletonsMask),
+                     [&](const Outcome &outcome) {
+                       layers[outcome.unseen]->Add(
+                           pass.Apply(key, outcome),
+                           probability * outcome.probability);
+                     });
+
+                 thread_states[thread_index]++;
+               }
+             });
+
+    layers[unseen].reset();
+  }
+
+  for (const std::uint64_t states : thread_states) {
+    state_count += states;
+  }
+
+  return std::move(layers[0]);
+}
+
+} // namespace
+
+bool ParseAnalysisPolicy(std::string_view name, AnalysisPolicy &policy) {
+  if (name == "perfect") {
+    policy = AnalysisPolicy::perfect;
+    return true;
+  }
+
+  if (name == "optimal") {
+    policy = AnalysisPolicy::optimal;
+    return true;
+  }
+
+  return false;
+}
+
+/* TranspositionTable */
+
+TranspositionTable::TranspositionTable(std::size_t capacity)
+    : m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      m_Keys(std::make_unique<std::atomic<std::uint64_t>[]>(m_Mask + 1)),
+      m_Probabilities(std::make_unique<std::atomic<double>[]>(m_Mask + 1)) {
+  for (std::size_t slot = 0; slot <= m_Mask; slot++) {
+    m_Keys[slot].store(kEmptyKey, std::memory_order_relaxed);
+    m_Probabilities[slot].store(0.0, std::memory_order_relaxed);
+  }
+}
+
+void TranspositionTable::Add(std::uint64_t key, double probability) {
+  std::size_t slot = MixSeed(key) & m_Mask;
+
+  // Linear probing, a slot's key never changes once claimed
+  for (std::size_t probes = 0; probes <= m_Mask; probes++) {
+    std::uint64_t slot_key = m_Keys[slot].load(std::memory_order_relaxed);
+
+    if (slot_key == kEmptyKey &&
+        m_Keys[slot].compare_exchange_strong(slot_key, key,
+                                             std::memory_order_relaxed)) {
+      slot_key = key;
+    }
+
+    if (slot_key == key) {
+      m_Probabilities[slot].fetch_add(probability, std::memory_order_relaxed);
+      return;
+    }
+
+    slot = (slot + 1) & m_Mask;
+  }
+
+  throw std::length_error("Transposition table is full");
+}
+
+/* Analysis */
+
+double AnalysisResult::MeanTurns() const {
+  double mean = 0.0;
+  for (const auto &[turns, probability] : turn_distribution) {
+    mean += turns * probability;
+  }
+  return mean;
+}
+
+AnalysisResult AnalyseGame(const AnalysisConfig &config,
+                           WorkStealingPool &pool) {
+  const std::uint64_t cards =
+      static_cast<std::uint64_t>(config.board_size) * config.board_size;
+
+  // At most half the cards are singletons
+  if (cards == 0 || cards % 2 != 0 || cards / 2 > kSingletonsMask ||
+      config.player_count == 0 || config.player_count > 8) {
+    throw std::invalid_argument("Board size or player count can't be "
+                                "analysed");
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  const std::uint32_t player_count = config.player_count;
+  const std::uint32_t pairs = static_cast<std::uint32_t>(cards / 2);
+
+  std::shared_ptr<const OptimalPlaySolver> solver{};
+  if (config.policy == AnalysisPolicy::optimal) {
+    solver = OptimalPlaySolver::For(static_cast<std::uint32_t>(cards));
+  }
+
+  AnalysisResult result{};
+  result.win_probability.assign(player_count, 0.0);
+
+  // Scores must fit their fields
+  const WinPass win_pass{static_cast<std::uint32_t>(cards), player_count};
+  if (pairs <= kMaxScore &&
+      kFieldsShift + kScoreBits * (player_count - 1) <= 64) {
+    const std::unique_ptr<TranspositionTable> finished = Propagate(
+        win_pass, config, solver.get(), pool, result.state_count);
+
+    if (finished != nullptr) {
+      std::vector<std::uint32_t> scores(player_count);
+
+      for (std::size_t slot = 0; slot < finished->GetCapacity(); slot++) {
+        if (!finished->IsUsed(slot)) {
+          continue;
+        }
+
+        const std::uint64_t fields = finished->GetKey(slot) >> kFieldsShift;
+        std::uint32_t rest = pairs;
+        for (std::uint32_t i = 0; i + 1 < player_count; i++) {
+          scores[i] = (fields >> (kScoreBits * i)) & kMaxScore;
+          rest -= scores[i];
+        }
+        scores[player_count - 1] = rest;
+
+        const std::uint32_t best =
+            *std::max_element(scores.begin(), scores.end());
+        const double probability = finished->GetProbability(slot);
+
+        std::uint32_t winners = 0;
+        for (std::uint32_t i = 0; i < player_count; i++) {
+          if (scores[i] == best) {
+            result.win_probability[i] += probability;
+            winners++;
+          }
+        }
+
+        if (winners > 1) {
+          result.tie_probability += probability;
+        }
+      }
+
+      result.wins_complete = true;
+    }
+  }
+
+  const TurnPass turn_pass{static_cast<std::uint32_t>(cards), player_count};
+  const std::unique_ptr<TranspositionTable> finished =
+      Propagate(turn_pass, config, solver.get(), pool, result.state_count);
+
+  if (finished != nullptr) {
+    for (std::size_t slot = 0; slot < finished->GetCapacity(); slot++) {
+      if (finished->IsUsed(slot)) {
+        const auto turn = static_cast<std::uint32_t>(finished->GetKey(slot) >>
+                                                     kFieldsShift);
+        result.turn_distribution[turn] += finished->GetProbability(slot);
+      }
+    }
+
+    result.turns_complete = true;
+  }
+
+  result.elapsed_seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+  return result;
+}
+
+} // namespace memory_game
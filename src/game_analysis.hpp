@@ -0,0 +1,117 @@
+#pragma once
+
+// local
+#include "work_stealing_pool.hpp"
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace memory_game {
+
+// Players of an analysed game, all of the same kind
+enum class AnalysisPolicy {
+  perfect, // PerfectMemoryPolicy
+  optimal, // OptimalPolicy
+};
+
+// Return policy for name "perfect" or "optimal". Returns false if the name is
+// not recognized.
+bool ParseAnalysisPolicy(std::string_view name, AnalysisPolicy &policy);
+
+// Fixed capacity hash map from a state key to the probability of reaching
+// it. Any number of threads can add to it at once without locks: a slot is
+// claimed by compare and swap of its key, probabilities are added
+// atomically.
+class TranspositionTable {
+public:
+  // Table for up to capacity / 2 keys
+  explicit TranspositionTable(std::size_t capacity);
+
+  // Add probability to key's entry, creating it if needed. Throws
+  // std::length_error if the table is full.
+  void Add(std::uint64_t key, double probability);
+
+  // Return number of slots
+  std::size_t GetCapacity() const { return m_Mask + 1; }
+
+  // Return whether slot holds a key, and its key and probability. Only call
+  // while no thread adds.
+  bool IsUsed(std::size_t slot) const {
+    return m_Keys[slot].load(std::memory_order_relaxed) != kEmptyKey;
+  }
+  std::uint64_t GetKey(std::size_t slot) const {
+    return m_Keys[slot].load(std::memory_order_relaxed);
+  }
+  double GetProbability(std::size_t slot) const {
+    return m_Probabilities[slot].load(std::memory_order_relaxed);
+  }
+
+  // Key of unused slots, never a state key
+  static constexpr std::uint64_t kEmptyKey = UINT64_MAX;
+
+private:
+  std::size_t m_Mask;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> m_Keys;
+  std::unique_ptr<std::atomic<double>[]> m_Probabilities;
+};
+
+// Exact analysis parameters
+struct AnalysisConfig {
+  std::uint32_t board_size = 4;
+  std::uint32_t player_count = 2;
+  AnalysisPolicy policy = AnalysisPolicy::perfect;
+
+  // Give up on a distribution if it could take more states than this
+  std::uint64_t max_states = std::uint64_t{1} << 24;
+};
+
+// Exact outcome distribution of one board size and player count
+struct AnalysisResult {
+  // Whether the distributions were computed, false if they could need more
+  // than max_states states
+  bool wins_complete = false;
+  bool turns_complete = false;
+
+  // Chance of each player winning (shared wins included)
+  std::vector<double> win_probability{};
+
+  // Chance of more than one winner
+  double tie_probability = 0.0;
+
+  // Turn number at the end of game -> chance
+  std::map<std::uint32_t, double> turn_distribution{};
+
+  // States visited by both passes
+  std::uint64_t state_count = 0;
+
+  double elapsed_seconds = 0.0;
+
+  // Return expected turn number at the end of game
+  double MeanTurns() const;
+};
+
+// Compute the exact chances of every outcome of config's game.
+//
+// Players that remember every card only care about how many face down cards
+// nobody has seen (unseen) and how many seen ones wait for an unseen partner
+// (singletons), not where the cards lie. Every turn reveals an unseen card,
+// so the game is a Markov chain whose states, grouped by unseen count, form
+// layers that only lead to lower layers. Probability flows from the first
+// layer down to the finished games at unseen 0, one layer at a time.
+//
+// Two passes keep the state small: one tracks (singletons, player to move,
+// scores) for the winners, one (singletons, player to move, turn number)
+// for the turn count. The states of a layer are expanded in parallel on
+// pool, adding into the transposition tables of the next two layers.
+// Probabilities are exact up to floating point rounding, whose order
+// depends on thread timing.
+AnalysisResult AnalyseGame(const AnalysisConfig &config,
+                           WorkStealingPool &pool);
+
+} // namespace memory_game
@@ -0,0 +1,131 @@
+// header
+#include "game_arena.hpp"
+
+// local
+#include "board_view.hpp"
+#include "card.hpp"
+
+// std
+#include <algorithm>
+
+namespace memory_game {
+
+namespace {
+
+// Round size up to a multiple of alignment (a power of two)
+constexpr std::size_t AlignUp(std::size_t size, std::size_t alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+/* SlabPool */
+
+SlabPool::SlabPool(std::size_t slab_size, std::pmr::memory_resource *upstream)
+    : m_SlabSize(AlignUp(std::max<std::size_t>(slab_size, 1), kCacheLineSize)),
+      m_Upstream(upstream) {}
+
+SlabPool::~SlabPool() {
+  for (std::byte *slab : m_FreeSlabs) {
+    m_Upstream->deallocate(slab, m_SlabSize, kCacheLineSize);
+  }
+}
+
+std::byte *SlabPool::Acquire() {
+  {
+    std::lock_guard lock(m_Mutex);
+
+    if (!m_FreeSlabs.empty()) {
+      std::byte *slab = m_FreeSlabs.back();
+      m_FreeSlabs.pop_back();
+      return slab;
+    }
+  }
+
+  return static_cast<std::byte *>(
+      m_Upstream->allocate(m_SlabSize, kCacheLineSize));
+}
+
+void SlabPool::Release(std::byte *slab) {
+  std::lock_guard lock(m_Mutex);
+  m_FreeSlabs.push_back(slab);
+}
+
+std::size_t SlabPool::GetFreeCount() const {
+  std::lock_guard lock(m_Mutex);
+  return m_FreeSlabs.size();
+}
+
+/* GameArena */
+
+GameArena::GameArena(SlabPool &pool)
+    : m_Pool(&pool), m_Upstream(std::pmr::new_delete_resource()),
+      m_Slab(pool.Acquire()), m_Size(pool.GetSlabSize()) {}
+
+GameArena::GameArena(std::size_t size, std::pmr::memory_resource *upstream)
+    : m_Upstream(upstream), m_Size(AlignUp(size, kCacheLineSize)) {
+  m_Slab = static_cast<std::byte *>(
+      m_Upstream->allocate(m_Size, kCacheLineSize));
+}
+
+GameArena::~GameArena() {
+  Reset();
+
+  if (m_Pool != nullptr) {
+    m_Pool->Release(m_Slab);
+  } else {
+    m_Upstream->deallocate(m_Slab, m_Size, kCacheLineSize);
+  }
+}
+
+void GameArena::Reset() {
+  // Rewinding the slab is all it takes unless something overflowed
+  for (const Overflow &overflow : m_Overflows) {
+    m_Upstream->deallocate(overflow.data, overflow.bytes, overflow.alignment);
+  }
+
+  m_Overflows.clear();
+  m_OverflowBytes = 0;
+  m_Used = 0;
+}
+
+std::size_t GameArena::SizeFor(std::uint32_t board_size,
+                               std::uint32_t player_count) {
+  const std::size_t cards = static_cast<std::size_t>(board_size) * board_size;
+  const std::size_t mask_words = (cards + 63) / 64;
+
+  const std::size_t row_words = (board_size + 63) / 64;
+
+  // Board, two masks and the dirty rows (unless they fit inline) and the
+  // player counters, each padded to a cache line
+  std::size_t size = AlignUp(cards * sizeof(CardId), kCacheLineSize);
+  if (mask_words > 2) {
+    size += 2 * AlignUp(mask_words * sizeof(std::uint64_t), kCacheLineSize);
+  }
+  if (row_words > 2) {
+    size += AlignUp(row_words * sizeof(std::uint64_t), kCacheLineSize);
+  }
+  size += AlignUp(player_count * sizeof(std::uint32_t), kCacheLineSize);
+
+  return size;
+}
+
+void *GameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  const std::size_t offset =
+      AlignUp(reinterpret_cast<std::uintptr_t>(m_Slab) + m_Used, alignment) -
+      reinterpret_cast<std::uintptr_t>(m_Slab);
+
+  if (offset <= m_Size && bytes <= m_Size - offset) {
+    m_Used = offset + bytes;
+    return m_Slab + offset;
+  }
+
+  // Slab is full, remember the allocation so Reset can free it
+  m_Overflows.reserve(m_Overflows.size() + 1);
+  void *data = m_Upstream->allocate(bytes, alignment);
+  m_Overflows.push_back({data, bytes, alignment});
+  m_OverflowBytes += bytes;
+  return data;
+}
+
+} // namespace memory_game
@@ -0,0 +1,111 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace memory_game {
+
+// Pool of equally sized, cache line aligned slabs that are reused between
+// games instead of going back to the heap. Thread safe.
+class SlabPool {
+public:
+  explicit SlabPool(std::size_t slab_size,
+                    std::pmr::memory_resource *upstream =
+                        std::pmr::new_delete_resource());
+
+  SlabPool(const SlabPool &) = delete;
+  SlabPool &operator=(const SlabPool &) = delete;
+
+  // Free the pooled slabs. Every acquired slab must have been released.
+  ~SlabPool();
+
+  // Return a free slab, allocating a new one if there is none
+  std::byte *Acquire();
+
+  // Give slab back for reuse
+  void Release(std::byte *slab);
+
+  // Return size of every slab in bytes
+  std::size_t GetSlabSize() const { return m_SlabSize; }
+
+  // Return number of slabs waiting for reuse
+  std::size_t GetFreeCount() const;
+
+private:
+  std::size_t m_SlabSize;
+  std::pmr::memory_resource *m_Upstream;
+
+  mutable std::mutex m_Mutex;
+  std::vector<std::byte *> m_FreeSlabs{}; // Guarded by m_Mutex
+};
+
+// Memory resource that bump allocates one game's state out of a single slab.
+// Deallocation is a no-op, everything is freed at once by Reset or when the
+// arena is destroyed, so ending a game costs O(1) however much it allocated.
+// Allocations that don't fit go to the upstream resource and are freed the
+// same way.
+//
+// Typical use, one arena per hosted game:
+//   GameArena arena(pool);
+//   MemoryLogic logic(board_size, player_count, &arena);
+class GameArena : public std::pmr::memory_resource {
+public:
+  // Use a slab from pool, returned when the arena is destroyed
+  explicit GameArena(SlabPool &pool);
+
+  // Use a slab of size bytes allocated from upstream
+  explicit GameArena(std::size_t size, std::pmr::memory_resource *upstream =
+                                           std::pmr::new_delete_resource());
+
+  GameArena(const GameArena &) = delete;
+  GameArena &operator=(const GameArena &) = delete;
+
+  ~GameArena() override;
+
+  // Free everything allocated so far. Anything still using the arena must be
+  // gone.
+  void Reset();
+
+  // Return bytes handed out from the slab, including alignment padding
+  std::size_t GetUsedBytes() const { return m_Used; }
+
+  // Return bytes that didn't fit and came from upstream
+  std::size_t GetOverflowBytes() const { return m_OverflowBytes; }
+
+  // Return slab size that fits a whole game of this size without overflow
+  static std::size_t SizeFor(std::uint32_t board_size,
+                             std::uint32_t player_count);
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+  // Allocation that came from upstream
+  struct Overflow {
+    void *data;
+    std::size_t bytes;
+    std::size_t alignment;
+  };
+
+  SlabPool *m_Pool = nullptr; // Owner of the slab, or nullptr if it's ours
+  std::pmr::memory_resource *m_Upstream;
+
+  std::byte *m_Slab;
+  std::size_t m_Size;
+  std::size_t m_Used = 0;
+
+  std::vector<Overflow> m_Overflows{};
+  std::size_t m_OverflowBytes = 0;
+};
+
+} // namespace memory_game
@@ -0,0 +1,93 @@
+// header
+#include "game_snapshot.hpp"
+
+// std
+#include <stdexcept>
+
+namespace memory_game {
+
+SnapshotPublisher::SnapshotPublisher(std::uint32_t max_handles)
+    // The latest slot and the held ones can't be written, one more always
+    // is free
+    : m_SlotCount(max_handles + 2) {
+  if (m_SlotCount > kSlotMask) {
+    throw std::invalid_argument("Too many snapshot handles");
+  }
+
+  m_Slots = std::make_unique<Slot[]>(m_SlotCount);
+}
+
+void SnapshotPublisher::Publish(const MemoryLogic &logic, bool new_board) {
+  // Readers of older deals keep the old ids alive through their snapshots
+  if (new_board || m_pBoard == nullptr) {
+    const BoardView<CardId> board = logic.GetBoard();
+    m_pBoard = std::make_shared<const std::vector<CardId>>(
+        board.data(), board.data() + logic.GetTotalCardsCount());
+  }
+
+  const std::uint64_t latest = m_Latest.load(std::memory_order_relaxed);
+  const std::uint64_t latest_slot =
+      latest == 0 ? m_SlotCount : latest & kSlotMask;
+
+  // Find a slot that's neither the latest nor held. Readers announce
+  // themselves before checking the latest slot again, so one that starts
+  // reading a slot after this saw no readers there retries elsewhere.
+  Slot *slot = nullptr;
+  std::uint32_t index = m_NextSlot;
+  for (std::uint32_t i = 0; i < m_SlotCount; i++) {
+    if (index != latest_slot && m_Slots[index].readers.load() == 0) {
+      slot = &m_Slots[index];
+      break;
+    }
+
+    index = index + 1 == m_SlotCount ? 0 : index + 1;
+  }
+
+  if (slot == nullptr) {
+    m_SkippedCount++;
+    return;
+  }
+
+  GameSnapshot &snapshot = slot->snapshot;
+  snapshot.version = ++m_Version;
+  snapshot.board_size = logic.GetBoardSize();
+  snapshot.player_count = logic.GetPlayerCount();
+  snapshot.player_index = logic.GetCurrentPlayerIndex();
+  snapshot.turn_number = logic.GetTurnNumber();
+  snapshot.status = logic.GetGameStatus();
+  snapshot.board = m_pBoard;
+
+  // Copies reuse the slot's buffers
+  snapshot.revealed = logic.GetHasCardBeenRevealed().bits();
+  snapshot.matched = logic.GetHasCardBeenMatched().bits();
+
+  snapshot.matched_counts.resize(snapshot.player_count);
+  for (std::uint32_t i = 0; i < snapshot.player_count; i++) {
+    snapshot.matched_counts[i] = logic.GetMatchedCardsCount(i);
+  }
+
+  m_Latest.store(m_Version << kSlotBits | index);
+  m_NextSlot = index + 1 == m_SlotCount ? 0 : index + 1;
+}
+
+SnapshotPublisher::Handle SnapshotPublisher::Acquire() const {
+  for (;;) {
+    const std::uint64_t latest = m_Latest.load();
+    if (latest == 0) {
+      return Handle{};
+    }
+
+    // Sequentially consistent, so either the publisher sees this reader or
+    // this reader sees the slot was replaced
+    Slot &slot = m_Slots[latest & kSlotMask];
+    slot.readers.fetch_add(1);
+
+    if (m_Latest.load() == latest) {
+      return Handle(&slot);
+    }
+
+    slot.readers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+} // namespace memory_game
@@ -0,0 +1,162 @@
+/*
+ *
+ * Lock free snapshots of a running game.
+ *
+ * MemoryLogic's getters return views into buffers that every selection
+ * changes in place, so only the thread playing the game may use them. A
+ * game with a SnapshotPublisher attached copies its state into an immutable
+ * GameSnapshot after every transition, and any number of other threads
+ * (spectators, loggers, autosave) read the latest one without locks and
+ * without ever making the game wait.
+ *
+ * Snapshots live in a fixed set of slots. The writer fills a slot nobody
+ * reads and publishes it with one atomic store of (version, slot). A reader
+ * announces itself in the published slot's reader count and checks that the
+ * slot is still the published one, retrying otherwise, so the writer never
+ * reuses a slot a reader holds. The card ids only change with a new board,
+ * so all snapshots of one deal share a single copy of them; a transition
+ * copies just the two bit masks and the counters, into buffers the slot
+ * keeps, so publishing doesn't allocate.
+ *
+ */
+
+#pragma once
+
+// local
+#include "board_view.hpp"
+#include "card.hpp"
+#include "dynamic_packed_bool_array.hpp"
+#include "memory_logic.hpp"
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace memory_game {
+
+// State of a game at one point in time
+struct GameSnapshot {
+  // Number of the transition, starts at 1 and increases by 1 per publish
+  std::uint64_t version = 0;
+
+  std::uint32_t board_size = 0;
+  std::uint32_t player_count = 0;
+  std::uint32_t player_index = 0;
+  std::uint32_t turn_number = 0;
+  GameStatus status = GameStatus::selectingFirstCard;
+
+  // Card ids indexed by x * board_size + y, shared by the snapshots of a deal
+  std::shared_ptr<const std::vector<CardId>> board{};
+
+  DynamicPackedBoolArray revealed{};
+  DynamicPackedBoolArray matched{};
+
+  // Pairs found by each player
+  std::vector<std::uint32_t> matched_counts{};
+
+  // Return 2D views like MemoryLogic's getters
+  BoardView<CardId> GetBoard() const { return {board->data(), board_size}; }
+  PackedBoolBoardView GetHasCardBeenRevealed() const {
+    return {revealed, board_size};
+  }
+  PackedBoolBoardView GetHasCardBeenMatched() const {
+    return {matched, board_size};
+  }
+};
+
+// Publishes snapshots of one game. Publish is called by the thread playing
+// the game, Acquire by any thread.
+class SnapshotPublisher {
+private:
+  struct Slot {
+    std::atomic<std::uint32_t> readers{0};
+    GameSnapshot snapshot{};
+  };
+
+public:
+  // Read access to a snapshot. The snapshot stays valid and unchanged while
+  // the handle lives, keep handles short lived.
+  class Handle {
+  public:
+    Handle() = default;
+    Handle(Handle &&other) noexcept : m_pSlot(other.m_pSlot) {
+      other.m_pSlot = nullptr;
+    }
+    Handle &operator=(Handle &&other) noexcept {
+      if (this != &other) {
+        Release();
+        m_pSlot = other.m_pSlot;
+        other.m_pSlot = nullptr;
+      }
+      return *this;
+    }
+    ~Handle() { Release(); }
+
+    // False if nothing had been published yet
+    explicit operator bool() const { return m_pSlot != nullptr; }
+
+    const GameSnapshot &operator*() const { return m_pSlot->snapshot; }
+    const GameSnapshot *operator->() const { return &m_pSlot->snapshot; }
+
+  private:
+    friend class SnapshotPublisher;
+
+    explicit Handle(Slot *slot) : m_pSlot(slot) {}
+
+    void Release() {
+      if (m_pSlot != nullptr) {
+        m_pSlot->readers.fetch_sub(1, std::memory_order_release);
+        m_pSlot = nullptr;
+      }
+    }
+
+    Slot *m_pSlot = nullptr;
+  };
+
+  // Publisher for up to max_handles handles held at once. Holding more
+  // never blocks the game, but transitions are then skipped until a handle
+  // is released.
+  explicit SnapshotPublisher(std::uint32_t max_handles = 6);
+
+  SnapshotPublisher(const SnapshotPublisher &) = delete;
+  SnapshotPublisher &operator=(const SnapshotPublisher &) = delete;
+
+  // Copy logic's state into a free slot and make it the latest snapshot.
+  // new_board says the card ids changed since the last call. Only the
+  // thread playing the game may call this, MemoryLogic does so itself.
+  void Publish(const MemoryLogic &logic, bool new_board);
+
+  // Return the latest snapshot, an empty handle if there is none. Never
+  // blocks, retries only if a publish lands in between.
+  Handle Acquire() const;
+
+  // Return version of the latest snapshot, 0 if there is none. Lets readers
+  // poll for changes without acquiring.
+  std::uint64_t GetVersion() const {
+    return m_Latest.load(std::memory_order_acquire) >> kSlotBits;
+  }
+
+  // Return number of transitions not published because every free slot
+  // was held. Only the publishing thread may call this.
+  std::uint64_t GetSkippedCount() const { return m_SkippedCount; }
+
+private:
+  // The latest snapshot is stored as version << kSlotBits | slot
+  static constexpr std::uint32_t kSlotBits = 16;
+  static constexpr std::uint64_t kSlotMask = (1u << kSlotBits) - 1;
+
+  std::uint32_t m_SlotCount;
+  std::unique_ptr<Slot[]> m_Slots;
+
+  std::atomic<std::uint64_t> m_Latest{0};
+
+  // Publisher's state
+  std::uint64_t m_Version = 0;
+  std::uint64_t m_SkippedCount = 0;
+  std::shared_ptr<const std::vector<CardId>> m_pBoard{}; // Current deal
+  std::uint32_t m_NextSlot = 0; // Where the search for a free slot starts
+};
+
+} // namespace memory_game
@@ -0,0 +1,344 @@
+/*
+ *
+ * Load generator for memory_server.
+ *
+ * Opens several connections and plays complete games on each of them with a
+ * perfect memory player, one request in flight per connection. Prints request
+ * throughput and latency percentiles.
+ *
+ * Usage: memory_loadgen [--socket PATH] [--connections N] [--games N]
+ *                       [--size N] [--players N]
+ *
+ */
+
+// local
+#include "common.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: memory_loadgen [--socket PATH] [--connections N] "
+               "[--games N] [--size N] [--players N]\n";
+}
+
+struct Config {
+  std::string socket_path = "memory_server.sock";
+  std::uint32_t connection_count = 4;
+  std::uint32_t game_count = 100; // Per connection
+  std::uint32_t board_size = 4;
+  std::uint32_t player_count = 2;
+};
+
+// Blocking request/reply client for one connection
+class Client {
+public:
+  explicit Client(const std::string &socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+      throw std::runtime_error("Socket path too long");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    m_Fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_Fd < 0 || connect(m_Fd, reinterpret_cast<const sockaddr *>(&address),
+                            sizeof(address)) != 0) {
+      const std::string error = std::strerror(errno);
+      if (m_Fd >= 0) {
+        close(m_Fd);
+      }
+      throw std::runtime_error("Unable to connect to " + socket_path + ": " +
+                               error);
+    }
+  }
+
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  ~Client() { close(m_Fd); }
+
+  // Send request and return the words of the reply after "<tag> ok". Throws
+  // on errors.
+  std::vector<std::string> Request(const std::string &request) {
+    const std::string tag = std::to_string(m_NextTag++);
+    const std::string line = tag + " " + request + "\n";
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t written = 0; written < line.size();) {
+      const ssize_t result = send(m_Fd, line.data() + written,
+                                  line.size() - written, MSG_NOSIGNAL);
+      if (result <= 0) {
+        throw std::runtime_error("Connection lost");
+      }
+      written += static_cast<std::size_t>(result);
+    }
+
+    const std::string reply = ReadLine();
+
+    m_Latencies.push_back(std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+
+    std::istringstream stream(reply);
+    std::vector<std::string> words;
+    for (std::string word; stream >> word;) {
+      words.push_back(word);
+    }
+
+    if (words.size() < 2 || words[0] != tag || words[1] != "ok") {
+      throw std::runtime_error("Request \"" + request + "\" failed: " + reply);
+    }
+
+    return {words.begin() + 2, words.end()};
+  }
+
+  // Request latencies in microseconds
+  const std::vector<double> &GetLatencies() const { return m_Latencies; }
+
+private:
+  std::string ReadLine() {
+    for (;;) {
+      if (const std::size_t end = m_Buffer.find('\n');
+          end != std::string::npos) {
+        std::string line = m_Buffer.substr(0, end);
+        m_Buffer.erase(0, end + 1);
+        return line;
+      }
+
+      char chunk[4096];
+      const ssize_t length = read(m_Fd, chunk, sizeof(chunk));
+      if (length <= 0) {
+        throw std::runtime_error("Connection lost");
+      }
+      m_Buffer.append(chunk, static_cast<std::size_t>(length));
+    }
+  }
+
+  int m_Fd = -1;
+  std::uint64_t m_NextTag = 0;
+  std::string m_Buffer{};
+  std::vector<double> m_Latencies{};
+};
+
+// Play one game to the end with perfect memory
+void PlayGame(Client &client, const Config &config) {
+  const std::string session =
+      client
+          .Request("new " + std::to_string(config.board_size) + " " +
+                   std::to_string(config.player_count))
+          .at(0);
+
+  const std::uint32_t size = config.board_size;
+  const std::uint32_t cards = size * size;
+
+  std::vector<int> known(cards, -1); // Seen card, -1 if unknown
+  std::unordered_map<int, std::vector<std::uint32_t>>
+      seen{}; // Face down cells of each seen card
+  std::uint32_t next_unknown = 0;
+
+  // Return next cell never seen, other than skip
+  const auto unknown_cell = [&](std::uint32_t skip) {
+    while (next_unknown < cards && known[next_unknown] != -1) {
+      next_unknown++;
+    }
+    std::uint32_t cell = next_unknown;
+    if (cell == skip) {
+      cell++;
+      while (cell < cards && known[cell] != -1) {
+        cell++;
+      }
+    }
+    return cell;
+  };
+
+  // Return a known face down pair, or cards if none
+  const auto known_pair = [&] {
+    for (const auto &[card, cells] : seen) {
+      if (cells.size() == 2) {
+        return cells[0];
+      }
+    }
+    return cards;
+  };
+
+  std::string status = "first";
+  std::uint32_t first = 0;
+
+  while (status != "finished") {
+    std::uint32_t cell = 0;
+
+    if (status == "mismatch") {
+      // Any selection hides the mismatched cards
+      cell = 0;
+    } else if (status == "first") {
+      cell = known_pair();
+      if (cell == cards) {
+        cell = unknown_cell(cards);
+      }
+      first = cell;
+    } else {
+      cell = cards;
+      for (const std::uint32_t other : seen[known[first]]) {
+        if (other != first) {
+          cell = other;
+        }
+      }
+      if (cell == cards) {
+        cell = unknown_cell(first);
+      }
+    }
+
+    const std::vector<std::string> reply =
+        client.Request("select " + session + " " + std::to_string(cell / size) +
+                       " " + std::to_string(cell % size));
+
+    const std::string previous = status;
+    status = reply.at(0);
+
+    // Selecting in mismatch only turns the pair back over, the card stays
+    // face down
+    int card = 0;
+    if (previous == "mismatch" || !parse_number(reply.at(3), card)) {
+      continue;
+    }
+
+    if (known[cell] == -1) {
+      known[cell] = card;
+      seen[card].push_back(cell);
+    }
+
+    // A second card that didn't lead to a mismatch was a match
+    if (previous == "second" && status != "mismatch") {
+      seen.erase(card);
+    }
+  }
+
+  client.Request("close " + session);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Config config{};
+
+  // Parse arguments
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+
+    const char *value = argv[++i];
+
+    bool valid = true;
+
+    if (arg == "--socket") {
+      config.socket_path = value;
+    } else if (arg == "--connections") {
+      valid = parse_number(value, config.connection_count);
+    } else if (arg == "--games") {
+      valid = parse_number(value, config.game_count);
+    } else if (arg == "--size") {
+      valid = parse_number(value, config.board_size);
+    } else if (arg == "--players") {
+      valid = parse_number(value, config.player_count);
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (config.connection_count == 0 || config.board_size == 0 ||
+      config.board_size % 2 != 0 || config.player_count == 0) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::vector<double>> latencies(config.connection_count);
+  std::vector<std::string> errors(config.connection_count);
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (std::uint32_t i = 0; i < config.connection_count; i++) {
+    threads.emplace_back([&, i] {
+      try {
+        Client client(config.socket_path);
+        for (std::uint32_t game = 0; game < config.game_count; game++) {
+          PlayGame(client, config);
+        }
+        latencies[i] = client.GetLatencies();
+      } catch (const std::exception &error) {
+        errors[i] = error.what();
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  const double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  for (const std::string &error : errors) {
+    if (!error.empty()) {
+      std::cerr << error << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<double> all;
+  for (const auto &connection : latencies) {
+    all.insert(all.end(), connection.begin(), connection.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  // Return latency at quantile q
+  const auto percentile = [&all](double q) {
+    return all.empty() ? 0.0 : all[static_cast<std::size_t>(q * (all.size() - 1))];
+  };
+
+  const std::uint64_t games =
+      static_cast<std::uint64_t>(config.connection_count) * config.game_count;
+
+  std::cout << "Connections:  " << config.connection_count << "\n"
+            << "Games:        " << games << "\n"
+            << "Requests:     " << all.size() << "\n"
+            << "Elapsed:      " << elapsed << " s\n"
+            << "Throughput:   " << all.size() / elapsed << " requests/s, "
+            << games / elapsed << " games/s\n"
+            << "Latency p50:  " << percentile(0.5) << " us\n"
+            << "Latency p99:  " << percentile(0.99) << " us\n"
+            << "Latency max:  " << percentile(1.0) << " us\n";
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+// header
+#include "logger.hpp"
+
+// local
+#include "fast_rng.hpp"
+
+// std
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace memory_game {
+
+namespace {
+
+// How often the drain thread looks for records
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+constexpr std::int64_t kNanosecondsPerSecond = 1'000'000'000;
+
+const char *LevelName(LogLevel level) {
+  switch (level) {
+  case LogLevel::debug:
+    return "debug";
+  case LogLevel::info:
+    return "info";
+  case LogLevel::warning:
+    return "warning";
+  case LogLevel::error:
+    return "error";
+  }
+  return "unknown";
+}
+
+// Write text as a logfmt value, quoted and escaped
+void WriteQuoted(std::ostream &out, std::string_view text) {
+  out << '"';
+  for (const char character : text) {
+    if (character == '"' || character == '\\') {
+      out << '\\' << character;
+    } else if (character == '\n') {
+      out << "\\n";
+    } else {
+      out << character;
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+Logger::Logger(const std::filesystem::path &filename, std::size_t capacity)
+    : m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      m_Cells(std::make_unique<Cell[]>(m_Mask + 1)), m_Filename(filename) {
+  for (std::size_t i = 0; i <= m_Mask; i++) {
+    m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  m_Thread = std::thread([this] { Run(); });
+}
+
+Logger::~Logger() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stopping = true;
+  }
+  m_Wake.notify_one();
+
+  m_Thread.join();
+}
+
+Logger &Logger::Get() {
+  static Logger logger("debug_output.txt");
+  return logger;
+}
+
+void Logger::SetOutput(const std::filesystem::path &filename) {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Filename = filename;
+}
+
+void Logger::Flush() {
+  const std::uint64_t target =
+      m_EnqueuePosition.load(std::memory_order_acquire);
+
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_FlushRequested = true;
+  m_Wake.notify_one();
+
+  m_Drained.wait(lock, [&] {
+    return m_DequeuePosition.load(std::memory_order_acquire) >= target;
+  });
+}
+
+bool Logger::Admit(const char *message, std::int64_t time,
+                   std::uint32_t &suppressed) {
+  Budget &budget = m_Budgets[MixSeed(reinterpret_cast<std::uintptr_t>(
+                                 message)) %
+                             kBudgetCount];
+
+  const std::uint64_t count_mask = (std::uint64_t{1} << kCountBits) - 1;
+  const std::uint64_t window =
+      static_cast<std::uint64_t>(time / kNanosecondsPerSecond) << kCountBits;
+
+  std::uint64_t state = budget.state.load(std::memory_order_relaxed);
+
+  for (;;) {
+    // First record of a new second, it reports the last one's suppressed
+    if ((state & ~count_mask) != window) {
+      if (budget.state.compare_exchange_weak(state, window | 1,
+                                             std::memory_order_relaxed)) {
+        suppressed = budget.suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+      }
+      continue;
+    }
+
+    if ((state & count_mask) >= kRateLimit) {
+      budget.suppressed.fetch_add(1, std::memory_order_relaxed);
+      m_SuppressedCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (budget.state.compare_exchange_weak(state, state + 1,
+                                           std::memory_order_relaxed)) {
+      suppressed = 0;
+      return true;
+    }
+  }
+}
+
+void Logger::Enqueue(LogLevel level, const char *source, const char *message,
+                     const LogFields &fields, std::string_view detail) {
+  const std::int64_t time =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+
+  std::uint32_t suppressed = 0;
+  if (!Admit(message, time, suppressed)) {
+    return;
+  }
+
+  // Claim a cell
+  Cell *cell = nullptr;
+  std::uint64_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+
+  for (;;) {
+    cell = &m_Cells[position & m_Mask];
+    const std::uint64_t sequence =
+        cell->sequence.load(std::memory_order_acquire);
+
+    if (sequence == position) {
+      if (m_EnqueuePosition.compare_exchange_weak(
+              position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position) {
+      // Full, the drain thread hasn't freed the cell yet
+      m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } else {
+      position = m_EnqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  Record &record = cell->record;
+  record.time = time;
+  record.source = source;
+  record.message = message;
+  record.fields = fields;
+  record.suppressed = suppressed;
+  record.level = level;
+  record.detail_size =
+      static_cast<std::uint16_t>(std::min(detail.size(), kMaxDetail));
+  std::memcpy(record.detail, detail.data(), record.detail_size);
+
+  cell->sequence.store(position + 1, std::memory_order_release);
+}
+
+void Logger::Drain() {
+  std::uint64_t position = m_DequeuePosition.load(std::memory_order_relaxed);
+  bool drained = false;
+
+  for (;;) {
+    Cell &cell = m_Cells[position & m_Mask];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+      break;
+    }
+
+    // Open the output on the first record and after SetOutput
+    if (!drained) {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if (m_Filename != m_OpenFilename) {
+        m_File.close();
+        m_File.clear();
+        m_File.open(m_Filename, std::ios::app);
+        m_OpenFilename = m_Filename;
+      }
+    }
+
+    Write(cell.record);
+
+    // Hand the cell to the producer of the next lap
+    cell.sequence.store(position + m_Mask + 1, std::memory_order_release);
+    position++;
+    m_DequeuePosition.store(position, std::memory_order_release);
+    drained = true;
+  }
+
+  if (drained && m_File.is_open()) {
+    m_File.flush();
+  }
+}
+
+void Logger::Write(const Record &record) {
+  if (!m_File.is_open()) {
+    return;
+  }
+
+  // UTC time with milliseconds
+  const std::time_t seconds =
+      static_cast<std::time_t>(record.time / kNanosecondsPerSecond);
+  std::tm utc{};
+#ifdef _WIN32
+  gmtime_s(&utc, &seconds);
+#else
+  gmtime_r(&seconds, &utc);
+#endif
+
+  char time[32];
+  const std::size_t length =
+      std::strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S", &utc);
+  std::snprintf(time + length, sizeof(time) - length, ".%03dZ",
+                static_cast<int>(record.time % kNanosecondsPerSecond /
+                                 1'000'000));
+
+  m_File << "time=" << time << " level=" << LevelName(record.level)
+         << " source=" << record.source << " msg=";
+  WriteQuoted(m_File, record.message);
+
+  const LogFields &fields = record.fields;
+  if (fields.game_id != 0) {
+    m_File << " game=" << fields.game_id;
+  }
+  if (fields.player != kNoLogValue) {
+    m_File << " player=" << fields.player;
+  }
+  if (fields.x != kNoLogValue) {
+    m_File << " x=" << fields.x;
+  }
+  if (fields.y != kNoLogValue) {
+    m_File << " y=" << fields.y;
+  }
+  if (record.detail_size > 0) {
+    m_File << " detail=";
+    WriteQuoted(m_File, std::string_view(record.detail, record.detail_size));
+  }
+  if (record.suppressed > 0) {
+    m_File << " suppressed=" << record.suppressed;
+  }
+
+  m_File << '\n';
+}
+
+void Logger::Run() {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+
+  for (;;) {
+    // Read before draining, so stopping is only seen once a drain started
+    // after it and everything queued before stopping has been written
+    const bool stopping = m_Stopping;
+
+    lock.unlock();
+    Drain();
+    lock.lock();
+
+    m_Drained.notify_all();
+
+    if (stopping) {
+      return;
+    }
+
+    m_Wake.wait_for(lock, kDrainInterval,
+                    [this] { return m_Stopping || m_FlushRequested; });
+    m_FlushRequested = false;
+  }
+}
+
+} // namespace memory_game
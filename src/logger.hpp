@@ -0,0 +1,184 @@
+/*
+ *
+ * Asynchronous structured logging.
+ *
+ * Log records are fixed size structs with a severity, where they come from
+ * (string literals, stored as pointers), the game, player and card they
+ * concern and a short text detail. Logging copies one into a bounded
+ * lock-free ring (Vyukov's MPMC array queue, with a single consumer) and
+ * returns. A background thread drains the ring every few milliseconds and
+ * writes the records as logfmt lines:
+ *
+ *   time=2024-05-01T12:00:00.123Z level=warning
+ *   source=MemoryLogic::SelectCard msg="..." game=3 player=1 x=9 y=2
+ *
+ * (one line per record). Logging never blocks and never allocates: records
+ * below the minimum level cost one atomic load, if the ring is full the
+ * record is dropped and counted. Each message is limited to kRateLimit
+ * records per second, the rest are counted and the next record of the
+ * message that gets through reports how many were suppressed.
+ *
+ */
+
+#pragma once
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace memory_game {
+
+// Severity of a log record
+enum class LogLevel : std::uint8_t {
+  debug,
+  info,
+  warning,
+  error,
+};
+
+// Value of a field that doesn't apply
+inline constexpr std::uint32_t kNoLogValue = UINT32_MAX;
+
+// Context of a log record, unset fields aren't written
+struct LogFields {
+  std::uint64_t game_id = 0; // 0 if unknown
+  std::uint32_t player = kNoLogValue;
+  std::uint32_t x = kNoLogValue;
+  std::uint32_t y = kNoLogValue;
+};
+
+class Logger {
+public:
+  // Write to filename, opened on the first record. capacity (a power of
+  // two) is the number of records the ring holds.
+  explicit Logger(const std::filesystem::path &filename,
+                  std::size_t capacity = 1024);
+
+  Logger(const Logger &) = delete;
+  Logger &operator=(const Logger &) = delete;
+
+  // Write what is queued and join the thread
+  ~Logger();
+
+  // Return the process wide logger, writing to debug_output.txt
+  static Logger &Get();
+
+  // Queue a record. source and message must be string literals (or live as
+  // long as the logger), detail is copied and cut to kMaxDetail bytes.
+  // Safe to call from any thread.
+  void Log(LogLevel level, const char *source, const char *message,
+           const LogFields &fields = {}, std::string_view detail = {}) {
+    if (level >= m_MinLevel.load(std::memory_order_relaxed)) {
+      Enqueue(level, source, message, fields, detail);
+    }
+  }
+
+  // Ignore records below level from now on
+  void SetMinLevel(LogLevel level) {
+    m_MinLevel.store(level, std::memory_order_relaxed);
+  }
+
+  // Write to filename from the next record on
+  void SetOutput(const std::filesystem::path &filename);
+
+  // Wait until every record queued before the call is written
+  void Flush();
+
+  // Return records dropped because the ring was full
+  std::uint64_t GetDroppedCount() const {
+    return m_DroppedCount.load(std::memory_order_relaxed);
+  }
+
+  // Return records suppressed by rate limiting
+  std::uint64_t GetSuppressedCount() const {
+    return m_SuppressedCount.load(std::memory_order_relaxed);
+  }
+
+  // Records of one message let through per second
+  static constexpr std::uint32_t kRateLimit = 20;
+
+  // Longest detail kept
+  static constexpr std::size_t kMaxDetail = 128;
+
+private:
+  struct Record {
+    std::int64_t time;   // Nanoseconds since the Unix epoch
+    const char *source;  // Where it was logged, e.g. "MemoryLogic::LoadState"
+    const char *message; // What happened
+    LogFields fields;
+    std::uint32_t suppressed; // Records of message suppressed before it
+    LogLevel level;
+    std::uint16_t detail_size;
+    char detail[kMaxDetail];
+  };
+
+  // Ring cell. sequence tells whose turn the cell is: the producer of
+  // position p waits for p, the consumer for p + 1.
+  struct Cell {
+    std::atomic<std::uint64_t> sequence;
+    Record record;
+  };
+
+  // Rate limit state of the messages hashing to it: the current second in
+  // the high bits, records let through in it in the low kCountBits
+  struct Budget {
+    std::atomic<std::uint64_t> state{0};
+    std::atomic<std::uint32_t> suppressed{0};
+  };
+
+  static constexpr std::uint32_t kCountBits = 16;
+  static constexpr std::size_t kBudgetCount = 64;
+
+  // Check message's rate limit for a record at time. Sets suppressed to the
+  // records it dropped since the last one let through.
+  bool Admit(const char *message, std::int64_t time,
+             std::uint32_t &suppressed);
+
+  void Enqueue(LogLevel level, const char *source, const char *message,
+               const LogFields &fields, std::string_view detail);
+
+  // Write every published record. Opens the output if it changed.
+  void Drain();
+
+  // Append record to the output as one line
+  void Write(const Record &record);
+
+  // Drain thread loop
+  void Run();
+
+  std::atomic<LogLevel> m_MinLevel{LogLevel::debug};
+
+  std::size_t m_Mask;
+  std::unique_ptr<Cell[]> m_Cells;
+
+  alignas(64) std::atomic<std::uint64_t> m_EnqueuePosition{0};
+  alignas(64) std::atomic<std::uint64_t> m_DequeuePosition{0};
+
+  std::atomic<std::uint64_t> m_DroppedCount{0};
+  std::atomic<std::uint64_t> m_SuppressedCount{0};
+
+  Budget m_Budgets[kBudgetCount];
+
+  // Only the drain thread writes the output
+  std::ofstream m_File{};
+  std::filesystem::path m_OpenFilename{};
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;    // Wakes the drain thread
+  std::condition_variable m_Drained; // Signalled after every drain
+  std::filesystem::path m_Filename;  // Guarded by m_Mutex
+  bool m_FlushRequested = false;     // Guarded by m_Mutex
+  bool m_Stopping = false;           // Guarded by m_Mutex
+
+  std::thread m_Thread; // Started last, once everything else is constructed
+};
+
+} // namespace memory_game
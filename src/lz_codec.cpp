@@ -0,0 +1,193 @@
+// header
+#include "lz_codec.hpp"
+
+// std
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace memory_game {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kMaxOffset = 0xFFFF;
+constexpr std::uint32_t kHashBits = 12;
+
+// Mark of an empty hash table entry
+constexpr std::uint32_t kNoPosition = UINT32_MAX;
+
+std::uint32_t Read32(const std::byte *data) {
+  std::uint32_t value = 0;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+std::uint32_t Hash(std::uint32_t value) {
+  return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+// Append the bytes extending a nibble of 15 to length
+void WriteLength(std::size_t length, std::vector<std::byte> &dst) {
+  for (; length >= 255; length -= 255) {
+    dst.push_back(std::byte{255});
+  }
+  dst.push_back(static_cast<std::byte>(length));
+}
+
+// Append sequence of literals and a match, match_length 0 for the last one
+void WriteSequence(const std::byte *literals, std::size_t literal_count,
+                   std::size_t offset, std::size_t match_length,
+                   std::vector<std::byte> &dst) {
+  const std::size_t match_code =
+      match_length == 0 ? 0 : match_length - kMinMatch;
+
+  dst.push_back(static_cast<std::byte>(
+      (literal_count < 15 ? literal_count : 15) << 4 |
+      (match_code < 15 ? match_code : 15)));
+
+  if (literal_count >= 15) {
+    WriteLength(literal_count - 15, dst);
+  }
+
+  dst.insert(dst.end(), literals, literals + literal_count);
+
+  if (match_length == 0) {
+    return;
+  }
+
+  dst.push_back(static_cast<std::byte>(offset & 0xFF));
+  dst.push_back(static_cast<std::byte>(offset >> 8));
+
+  if (match_code >= 15) {
+    WriteLength(match_code - 15, dst);
+  }
+}
+
+// Read the bytes extending a nibble of 15 into length. Returns false at the
+// end of the input.
+bool ReadLength(const std::byte *&in, const std::byte *end,
+                std::size_t &length) {
+  for (;;) {
+    if (in == end) {
+      return false;
+    }
+
+    const auto byte = static_cast<std::size_t>(*in++);
+    length += byte;
+
+    if (byte != 255) {
+      return true;
+    }
+  }
+}
+
+} // namespace
+
+void LzCompress(std::span<const std::byte> src, std::vector<std::byte> &dst) {
+  const std::byte *data = src.data();
+  const std::size_t size = src.size();
+
+  std::array<std::uint32_t, 1u << kHashBits> positions;
+  positions.fill(kNoPosition);
+
+  std::size_t anchor = 0; // Start of the pending literals
+  std::size_t position = 0;
+  std::size_t misses = 0;
+
+  while (position + kMinMatch <= size) {
+    const std::uint32_t value = Read32(data + position);
+    const std::uint32_t hash = Hash(value);
+    const std::uint32_t candidate = positions[hash];
+    positions[hash] = static_cast<std::uint32_t>(position);
+
+    if (candidate == kNoPosition || position - candidate > kMaxOffset ||
+        Read32(data + candidate) != value) {
+      // Skip faster through data that doesn't compress
+      position += 1 + (misses++ >> 5);
+      continue;
+    }
+
+    std::size_t length = kMinMatch;
+    while (position + length < size &&
+           data[candidate + length] == data[position + length]) {
+      length++;
+    }
+
+    WriteSequence(data + anchor, position - anchor, position - candidate,
+                  length, dst);
+
+    position += length;
+    anchor = position;
+    misses = 0;
+  }
+
+  WriteSequence(data + anchor, size - anchor, 0, 0, dst);
+}
+
+bool LzDecompress(std::span<const std::byte> src, std::span<std::byte> dst) {
+  const std::byte *in = src.data();
+  const std::byte *const in_end = in + src.size();
+  std::size_t out = 0;
+
+  while (in != in_end) {
+    const auto token = static_cast<std::size_t>(*in++);
+
+    // Literals
+    std::size_t literal_count = token >> 4;
+    if (literal_count == 15 && !ReadLength(in, in_end, literal_count)) {
+      return false;
+    }
+
+    if (literal_count > static_cast<std::size_t>(in_end - in) ||
+        literal_count > dst.size() - out) {
+      return false;
+    }
+
+    if (literal_count > 0) {
+      std::memcpy(dst.data() + out, in, literal_count);
+    }
+    in += literal_count;
+    out += literal_count;
+
+    // The last sequence has no match
+    if (in == in_end) {
+      break;
+    }
+
+    // Match
+    if (in_end - in < 2) {
+      return false;
+    }
+
+    const std::size_t offset = static_cast<std::size_t>(in[0]) |
+                               static_cast<std::size_t>(in[1]) << 8;
+    in += 2;
+
+    std::size_t length = token & 0xF;
+    if (length == 15 && !ReadLength(in, in_end, length)) {
+      return false;
+    }
+    length += kMinMatch;
+
+    if (offset == 0 || offset > out || length > dst.size() - out) {
+      return false;
+    }
+
+    // A match overlapping its own output is copied byte by byte
+    const std::byte *from = dst.data() + out - offset;
+    std::byte *to = dst.data() + out;
+    if (offset >= length) {
+      std::memcpy(to, from, length);
+    } else {
+      for (std::size_t i = 0; i < length; i++) {
+        to[i] = from[i];
+      }
+    }
+    out += length;
+  }
+
+  return out == dst.size();
+}
+
+} // namespace memory_game
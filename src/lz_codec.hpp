@@ -0,0 +1,35 @@
+/*
+ *
+ * Small LZ77 codec for save images, in the spirit of LZ4's block format.
+ *
+ * Compressed data is a list of sequences. Each is a token byte whose high
+ * nibble is the literal count and low nibble the match length minus 4, the
+ * literals, a 2 byte little endian offset back into the output and the
+ * match. A nibble of 15 is followed by bytes adding to it, 255 meaning
+ * another byte follows. The last sequence ends after its literals.
+ *
+ * Save images are mostly zero padding, sparse bit masks and card ids, so
+ * greedy matching on a 4 byte hash gets most of the gain at memcpy-like
+ * speed. Decompression checks every length and offset, corrupted input
+ * fails instead of reading or writing out of bounds.
+ *
+ */
+
+#pragma once
+
+// std
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace memory_game {
+
+// Compress src and append the result to dst
+void LzCompress(std::span<const std::byte> src, std::vector<std::byte> &dst);
+
+// Decompress src into dst, whose size must be the original size. Returns
+// false if src is corrupted or doesn't decompress to exactly dst.size()
+// bytes.
+bool LzDecompress(std::span<const std::byte> src, std::span<std::byte> dst);
+
+} // namespace memory_game
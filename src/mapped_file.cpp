@@ -0,0 +1,149 @@
+// header
+#include "mapped_file.hpp"
+
+// std
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory_game {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path &filename) {
+  HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return;
+  }
+
+  m_IsOpen = true;
+  m_Size = static_cast<std::size_t>(size.QuadPart);
+
+  // Mapping an empty file fails, there is nothing to map anyway
+  if (m_Size == 0) {
+    CloseHandle(file);
+    return;
+  }
+
+  m_Mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+  // The mapping keeps the file alive
+  CloseHandle(file);
+
+  if (m_Mapping == nullptr) {
+    Close();
+    return;
+  }
+
+  m_Data = static_cast<const std::byte *>(
+      MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+
+  if (m_Data == nullptr) {
+    Close();
+  }
+}
+
+void MappedFile::Close() {
+  if (m_Data != nullptr) {
+    UnmapViewOfFile(m_Data);
+  }
+
+  if (m_Mapping != nullptr) {
+    CloseHandle(m_Mapping);
+  }
+
+  m_IsOpen = false;
+  m_Data = nullptr;
+  m_Size = 0;
+  m_Mapping = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path &filename) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return;
+  }
+
+  m_IsOpen = true;
+  m_Size = static_cast<std::size_t>(info.st_size);
+
+  // Mapping an empty file fails, there is nothing to map anyway
+  if (m_Size == 0) {
+    close(fd);
+    return;
+  }
+
+  void *data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // The mapping keeps the file alive
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    Close();
+    return;
+  }
+
+  m_Data = static_cast<const std::byte *>(data);
+}
+
+void MappedFile::Close() {
+  if (m_Data != nullptr) {
+    munmap(const_cast<std::byte *>(m_Data), m_Size);
+  }
+
+  m_IsOpen = false;
+  m_Data = nullptr;
+  m_Size = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Close();
+
+    m_IsOpen = std::exchange(other.m_IsOpen, false);
+    m_Data = std::exchange(other.m_Data, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+    m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+  }
+
+  return *this;
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+} // namespace memory_game
@@ -0,0 +1,47 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace memory_game {
+
+// Read-only memory mapping of a whole file (mmap on POSIX, file mapping on
+// Windows). The mapping is released in dtor.
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  // Map file, IsOpen() tells whether it worked
+  explicit MappedFile(const std::filesystem::path &filename);
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  ~MappedFile();
+
+  // Whether the file was opened. Empty files are open but have no data.
+  bool IsOpen() const { return m_IsOpen; }
+
+  // Return mapped bytes
+  std::span<const std::byte> GetData() const { return {m_Data, m_Size}; }
+
+private:
+  // Unmap and close everything
+  void Close();
+
+  bool m_IsOpen = false;
+
+  const std::byte *m_Data = nullptr; // Start of the mapping
+  std::size_t m_Size = 0;            // Size of the file in bytes
+
+#ifdef _WIN32
+  void *m_Mapping = nullptr; // File mapping object handle
+#endif
+};
+
+} // namespace memory_game
@@ -0,0 +1,34 @@
+/*
+ *
+ * Public header of the memory_core library.
+ *
+ * Include this to embed the headless game engine without depending on FTXUI
+ * or a terminal. Everything reachable from here is built into memory_core.
+ *
+ */
+
+#pragma once
+
+// local
+#include "autosave.hpp"
+#include "background_worker.hpp"
+#include "board_view.hpp"
+#include "card.hpp"
+#include "common.hpp"
+#include "computer_players.hpp"
+#include "dynamic_packed_bool_array.hpp"
+#include "fast_rng.hpp"
+#include "game_analysis.hpp"
+#include "game_arena.hpp"
+#include "game_snapshot.hpp"
+#include "logger.hpp"
+#include "lz_codec.hpp"
+#include "mapped_file.hpp"
+#include "memory_logic.hpp"
+#include "move_journal.hpp"
+#include "optimal_policy.hpp"
+#include "save_archive.hpp"
+#include "save_format.hpp"
+#include "session_host.hpp"
+#include "simulation.hpp"
+#include "work_stealing_pool.hpp"
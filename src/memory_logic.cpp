@@ -1,16 +1,37 @@
 // header
 #include "memory_logic.hpp"
 
+// local
+#include "common.hpp"
+#include "game_snapshot.hpp"
+#include "logger.hpp"
+#include "mapped_file.hpp"
+#include "move_journal.hpp"
+#include "save_format.hpp"
+
 // std
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
-#include <fstream>
-#include <numeric>
-#include <random>
+#include <optional>
 #include <set>
 
 namespace memory_game {
 
+namespace {
+
+// Copy row x of a size x size bit mask from a byte aligned buffer. Legacy save
+// files store every mask row padded to whole bytes.
+void UnpackMaskRow(DynamicPackedBoolArray &mask, const std::uint32_t size,
+                   const std::uint32_t x,
+                   const std::vector<std::uint8_t> &row) {
+  for (std::uint32_t y = 0; y < size; y++) {
+    mask.Set(x * size + y, (row[y / 8] & (1 << (y % 8))) != 0);
+  }
+}
+
+} // namespace
+
 MemoryLogic::MemoryLogic(std::uint32_t board_size) : m_BoardSize(board_size) {
   // Initialize the board and game state
   InitializeBoard();
@@ -22,6 +43,16 @@ MemoryLogic::MemoryLogic(std::uint32_t board_size, std::uint32_t player_count)
   InitializeBoard();
 }
 
+MemoryLogic::MemoryLogic(std::uint32_t board_size, std::uint32_t player_count,
+                         std::pmr::memory_resource *resource)
+    : m_Board(resource), m_HasCardBeenRevealed(resource),
+      m_HasCardBeenMatched(resource), m_DirtyRows(resource),
+      m_BoardSize(board_size),
+      m_PlayersCount(player_count), m_PlayersMatchedCardsCount(resource) {
+  // Initialize the board and game state
+  InitializeBoard();
+}
+
 // Set board size
 void MemoryLogic::SetBoardSize(std::uint32_t board_size) {
   m_BoardSize = board_size;
@@ -31,16 +62,64 @@ void MemoryLogic::SetBoardSize(std::uint32_t board_size) {
 }
 
 void MemoryLogic::SelectCard(std::uint32_t current_x, std::uint32_t current_y) {
-  // Check whether the coordinates exceed board size
-  if (current_x > m_BoardSize || current_y > m_BoardSize) {
-    std::ofstream debug_stream("debug_output.txt",
-                               std::ios::app); // Debug output stream
+  const GameStatus status = m_GameStatus;
+
+  ApplySelection(current_x, current_y);
+
+  // Only selections that changed the game are published and recorded
+  if (m_GameStatus == status) {
+    return;
+  }
+
+  PublishSnapshot(false);
+
+  if (m_Journal.target == nullptr) {
+    return;
+  }
+
+  if (status == GameStatus::cardsDidntMatch) {
+    m_Journal.target->AppendHide();
+  } else {
+    m_Journal.target->AppendSelect(
+        static_cast<std::uint32_t>(CardIndex(current_x, current_y)));
+  }
+}
+
+void MemoryLogic::SetJournal(MoveJournal *journal) {
+  m_Journal.target = journal;
+
+  RestartJournal();
+}
 
-    debug_stream << "[MemoryLogic::SelectCard] Selected card coordinates "
-                    "exceed board size"
-                 << std::endl;
+void MemoryLogic::SetSnapshotPublisher(SnapshotPublisher *publisher) {
+  m_Publisher.target = publisher;
 
-    debug_stream.close();
+  PublishSnapshot(true);
+}
+
+void MemoryLogic::PublishSnapshot(bool new_board) {
+  if (m_Publisher.target != nullptr) {
+    m_Publisher.target->Publish(*this, new_board);
+  }
+}
+
+void MemoryLogic::RestartJournal() {
+  if (m_Journal.target == nullptr) {
+    return;
+  }
+
+  std::vector<std::byte> image{};
+  SerializeState(image);
+  m_Journal.target->BeginFromSnapshot(std::move(image));
+}
+
+void MemoryLogic::ApplySelection(std::uint32_t current_x,
+                                 std::uint32_t current_y) {
+  // Check whether the coordinates exceed board size
+  if (current_x >= m_BoardSize || current_y >= m_BoardSize) {
+    Logger::Get().Log(LogLevel::warning, "MemoryLogic::SelectCard",
+                      "Selected card coordinates exceed board size",
+                      {m_GameId, m_PlayerIndex, current_x, current_y});
     return;
   }
 
@@ -49,14 +128,17 @@ void MemoryLogic::SelectCard(std::uint32_t current_x, std::uint32_t current_y) {
     return;
   }
 
+  const std::size_t current_index = CardIndex(current_x, current_y);
+
   if (m_GameStatus == GameStatus::selectingFirstCard) {
     // If the card is already revlead: return
-    if (m_HasCardBeenRevealed[current_x][current_y]) {
+    if (m_HasCardBeenRevealed.Test(current_index)) {
       return;
     }
 
     // Reveal card
-    m_HasCardBeenRevealed[current_x][current_y] = true;
+    m_HasCardBeenRevealed.SetUnchecked(current_index, true);
+    MarkRowDirty(current_index);
 
     // Store the card coordinates for next stage
     m_PreviousX = current_x;
@@ -69,25 +151,27 @@ void MemoryLogic::SelectCard(std::uint32_t current_x, std::uint32_t current_y) {
 
   } else if (m_GameStatus == GameStatus::selectingSecondCard) {
     // If the card is already revlead: return
-    if (m_HasCardBeenRevealed[current_x][current_y]) {
+    if (m_HasCardBeenRevealed.Test(current_index)) {
       return;
     }
 
     // Reveal card
-    m_HasCardBeenRevealed[current_x][current_y] = true;
+    m_HasCardBeenRevealed.SetUnchecked(current_index, true);
+
+    // Either both cards get matched or, in a saved image, both get hidden
+    MarkRowDirty(current_index);
+    MarkRowDirty(CardIndex(m_PreviousX, m_PreviousY));
 
     // Check if the cards match
     if (CheckMatch(current_x, current_y, m_PreviousX, m_PreviousY)) {
-      m_HasCardBeenMatched[current_x][current_y] = true;
-      m_HasCardBeenMatched[m_PreviousX][m_PreviousY] = true;
+      m_HasCardBeenMatched.SetUnchecked(current_index, true);
+      m_HasCardBeenMatched.SetUnchecked(CardIndex(m_PreviousX, m_PreviousY),
+                                        true);
 
       m_PlayersMatchedCardsCount[m_PlayerIndex]++;
 
       // Check if all cards are matched
-      if (std::reduce(m_PlayersMatchedCardsCount.begin(),
-                      m_PlayersMatchedCardsCount.end()) *
-              2 <
-          GetTotalCardsCount()) {
+      if (!m_HasCardBeenMatched.All()) {
         m_GameStatus = GameStatus::selectingFirstCard;
       } else {
         m_GameStatus = GameStatus::gameFinished;
@@ -114,8 +198,11 @@ void MemoryLogic::SelectCard(std::uint32_t current_x, std::uint32_t current_y) {
     return;
   } else if (m_GameStatus == GameStatus::cardsDidntMatch) {
     // Hide cards after they didn't match
-    m_HasCardBeenRevealed[m_TempX][m_TempY] = false;
-    m_HasCardBeenRevealed[m_PreviousX][m_PreviousY] = false;
+    m_HasCardBeenRevealed.SetUnchecked(CardIndex(m_TempX, m_TempY), false);
+    m_HasCardBeenRevealed.SetUnchecked(CardIndex(m_PreviousX, m_PreviousY),
+                                       false);
+    MarkRowDirty(CardIndex(m_TempX, m_TempY));
+    MarkRowDirty(CardIndex(m_PreviousX, m_PreviousY));
 
     // Go back to first card selection stage
     m_GameStatus = GameStatus::selectingFirstCard;
@@ -124,52 +211,53 @@ void MemoryLogic::SelectCard(std::uint32_t current_x, std::uint32_t current_y) {
   }
 }
 
+void MemoryLogic::InitializeBoard(std::uint64_t seed) {
+  SetSeed(seed);
+
+  DealBoard();
+
+  PublishSnapshot(true);
+
+  if (m_Journal.target != nullptr) {
+    m_Journal.target->Begin(m_BoardSize, m_PlayersCount, seed);
+  }
+}
+
 void MemoryLogic::InitializeBoard() {
+  // Every board comes from a seed of its own, so a journal can record it as
+  // that seed
+  InitializeBoard(m_Rng());
+}
+
+void MemoryLogic::DealBoard() {
   // Clear board and game state
   ResetState();
 
-  // Generate cards
-  std::vector<char> cards;
-  cards.resize(GetTotalCardsCount());
+  // Initialize the board buffers
+  ResizeBoard();
+  m_PlayersMatchedCardsCount.resize(m_PlayersCount, 0);
 
-  for (std::size_t i = 0; i < cards.size(); i += 2) {
-    char c = 'A' + i / 2;
-    cards[i] = c;
-    cards[i + 1] = c;
+  // Generate cards straight into the board, pair n has id n
+  for (std::size_t i = 0; i < m_Board.size(); i += 2) {
+    const CardId card = static_cast<CardId>(i / 2);
+    m_Board[i] = card;
+    m_Board[i + 1] = card;
   }
 
   // Randomize/shuffle cards
-  std::random_device rd;  // Obtain a random number from hardware
-  std::mt19937 eng(rd()); // Seed the generator
-  std::shuffle(cards.begin(), cards.end(), eng); // Shuffle the cards
-
-  // Initialize and fill the vectors
-  m_Board.resize(m_BoardSize, std::vector<char>(m_BoardSize));
-  m_HasCardBeenRevealed.resize(m_BoardSize);
-  m_HasCardBeenMatched.resize(m_BoardSize);
-  m_PlayersMatchedCardsCount.resize(m_PlayersCount, 0);
-
-  for (std::uint32_t i = 0; i < m_BoardSize; ++i) {
-    // Resize the DynamicPackedBoolArray and initialize it to zero
-    m_HasCardBeenRevealed[i].Resize(m_BoardSize);
-    m_HasCardBeenMatched[i].Resize(m_BoardSize);
-
-    for (std::uint32_t j = 0; j < m_BoardSize; ++j) {
-      m_Board[i][j] = cards[i * m_BoardSize + j];
-    }
-  }
+  Shuffle(m_Board.begin(), m_Board.end(), m_Rng);
 }
 
 bool MemoryLogic::CheckMatch(std::uint32_t x1, std::uint32_t y1,
                              std::uint32_t x2, std::uint32_t y2) const {
-  return m_Board[x1][y1] == m_Board[x2][y2] && !(x1 == x2 && y1 == y2);
+  return m_Board[CardIndex(x1, y1)] == m_Board[CardIndex(x2, y2)] &&
+         !(x1 == x2 && y1 == y2);
 }
 
 void MemoryLogic::ResetState() {
-  // Clear vectors
+  // Clear vectors. The capacity is kept, so resetting a board of the same size
+  // doesn't allocate.
   m_Board.clear();
-  m_HasCardBeenRevealed.clear();
-  m_HasCardBeenMatched.clear();
   m_PlayersMatchedCardsCount.clear();
 
   // Reset game state
@@ -178,138 +266,262 @@ void MemoryLogic::ResetState() {
   m_GameStatus = GameStatus::selectingFirstCard;
 }
 
-void MemoryLogic::SaveState(const std::filesystem::path &filename) {
+void MemoryLogic::ResizeBoard() {
+  m_Board.resize(GetTotalCardsCount());
+
+  // Resize the masks and initialize them to zero
+  m_HasCardBeenRevealed.Resize(GetTotalCardsCount());
+  m_HasCardBeenRevealed.SetToZero();
+  m_HasCardBeenMatched.Resize(GetTotalCardsCount());
+  m_HasCardBeenMatched.SetToZero();
+
+  // Everything changed
+  m_DirtyRows.Resize(m_BoardSize);
+  for (std::uint32_t x = 0; x < m_BoardSize; x++) {
+    m_DirtyRows.SetUnchecked(x, true);
+  }
+}
+
+bool MemoryLogic::SaveState(const std::filesystem::path &filename) const {
+  std::vector<std::byte> image{};
+  SerializeState(image);
+
+  if (!write_file_atomically(filename, image)) {
+    Logger::Get().Log(LogLevel::error, "MemoryLogic::SaveState",
+                      "Unable to write file", {m_GameId}, filename.string());
+    return false;
+  }
+
+  return true;
+}
+
+void MemoryLogic::SerializeState(std::vector<std::byte> &image) const {
+  const std::uint32_t card_width = GetCardWidth(m_Board.size() / 2);
+  const SaveLayout layout =
+      SaveLayout::For(m_BoardSize, m_PlayersCount, card_width);
+
+  image.assign(layout.file_size, std::byte{0});
+
+  SaveHeader header{};
+  header.board_size = m_BoardSize;
+  header.player_count = m_PlayersCount;
+  header.game_status = static_cast<std::uint32_t>(m_GameStatus);
+  header.player_index = m_PlayerIndex;
+  header.previous_x = m_PreviousX;
+  header.previous_y = m_PreviousY;
+  header.turn_number = m_TurnNumber;
+  header.card_width = card_width;
+
+  std::memcpy(image.data(), &header, sizeof(header));
+  std::memcpy(image.data() + layout.counts_offset,
+              m_PlayersMatchedCardsCount.data(),
+              m_PlayersCount * sizeof(m_PlayersMatchedCardsCount[0]));
+  StoreBoard(image, layout, m_Board.data(), m_Board.size());
+  std::memcpy(image.data() + layout.revealed_offset,
+              m_HasCardBeenRevealed.GetPtr(),
+              layout.mask_words * sizeof(std::uint64_t));
+  std::memcpy(image.data() + layout.matched_offset,
+              m_HasCardBeenMatched.GetPtr(),
+              layout.mask_words * sizeof(std::uint64_t));
+
   // Prevent a weird bug when you save on
   // `m_GameStatus == GameStatus::cardsDidntMatch`
   //
   // After loading and pressing enter the
   // `m_Revealed[m_TempX][m_TempY]` wouldn't hide since
-  // m_TempX and m_TempY are not stored.
+  // m_TempX and m_TempY are not stored. Save the state as if the cards were
+  // already hidden instead.
   if (m_GameStatus == GameStatus::cardsDidntMatch) {
-    m_HasCardBeenRevealed[m_TempX][m_TempY] = false;
-    m_HasCardBeenRevealed[m_PreviousX][m_PreviousY] = false;
+    auto *revealed = reinterpret_cast<std::uint64_t *>(image.data() +
+                                                       layout.revealed_offset);
 
-    m_GameStatus = GameStatus::selectingFirstCard;
+    for (const std::size_t index :
+         {CardIndex(m_TempX, m_TempY), CardIndex(m_PreviousX, m_PreviousY)}) {
+      revealed[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+    }
+
+    auto &saved_header = *reinterpret_cast<SaveHeader *>(image.data());
+    saved_header.game_status =
+        static_cast<std::uint32_t>(GameStatus::selectingFirstCard);
   }
 
-  // Open file for writing in binary format
-  std::ofstream file(filename, std::ios::binary);
+  SealSaveImage(image);
+}
+
+bool MemoryLogic::LoadState(const std::filesystem::path &filename) {
+  // Map the file, a valid save is then used in place
+  const MappedFile file(filename);
 
   // If the file didn't open note and return
-  if (!file.is_open()) {
-    std::ofstream debug_stream("debug_output.txt",
-                               std::ios::app); // Debug output stream
+  if (!file.IsOpen()) {
+    Logger::Get().Log(LogLevel::error, "MemoryLogic::LoadState",
+                      "Unable to open file", {m_GameId}, filename.string());
+    return false;
+  }
 
-    debug_stream << "[MemoryLogic::SaveState] Unable to open file: " << filename
-                 << std::endl;
+  return LoadStateFromImage(file.GetData());
+}
 
-    debug_stream.close();
-    return;
+bool MemoryLogic::LoadStateFromImage(std::span<const std::byte> image) {
+  std::string error{};
+
+  // Files from before the save format had a header
+  if (!IsSaveImage(image)) {
+    if (!LoadLegacyState(image, error)) {
+      Logger::Get().Log(LogLevel::error, "MemoryLogic::LoadState",
+                        "Invalid save", {m_GameId}, error);
+      return false;
+    }
+
+    PublishSnapshot(true);
+    RestartJournal();
+    return true;
   }
 
-  // Save board state
-  file.write(reinterpret_cast<const char *>(&m_BoardSize), sizeof(m_BoardSize));
-  file.write(reinterpret_cast<const char *>(&m_GameStatus),
-             sizeof(m_GameStatus));
-  file.write(reinterpret_cast<const char *>(&m_PlayersCount),
-             sizeof(m_PlayersCount));
-  file.write(reinterpret_cast<const char *>(&m_PlayerIndex),
-             sizeof(m_PlayerIndex));
-
-  // Save selected card
-  file.write(reinterpret_cast<const char *>(&m_PreviousX), sizeof(m_PreviousX));
-  file.write(reinterpret_cast<const char *>(&m_PreviousY), sizeof(m_PreviousY));
-
-  // Save players matched cards count
-  file.write(reinterpret_cast<const char *>(m_PlayersMatchedCardsCount.data()),
-             m_PlayersCount * sizeof(m_PlayersMatchedCardsCount[0]));
-
-  for (std::size_t i = 0; i < m_BoardSize; i++) {
-    // Save board
-    file.write(reinterpret_cast<const char *>(m_Board[i].data()),
-               m_Board[i].size() * sizeof(m_Board[i][0]));
-
-    // Save which cards are revealed
-    file.write(
-        reinterpret_cast<const char *>(m_HasCardBeenRevealed[i].GetPtr()),
-        m_HasCardBeenRevealed[i].GetSizeInBytes());
-
-    // Save which cards are matched
-    file.write(reinterpret_cast<const char *>(m_HasCardBeenMatched[i].GetPtr()),
-               m_HasCardBeenMatched[i].GetSizeInBytes());
+  const std::optional<SaveView> view = SaveView::Parse(image, error);
+
+  // Leave the current game untouched if the save is invalid
+  if (!view) {
+    Logger::Get().Log(LogLevel::error, "MemoryLogic::LoadState",
+                      "Invalid save", {m_GameId}, error);
+    return false;
   }
 
-  // Close file
-  file.close();
+  // Load board state
+  const SaveHeader &header = view->GetHeader();
+  m_BoardSize = header.board_size;
+  m_GameStatus = static_cast<GameStatus>(header.game_status);
+  m_PlayersCount = header.player_count;
+  m_PlayerIndex = header.player_index;
+  m_TurnNumber = header.turn_number;
+
+  // Load cursor state
+  m_PreviousX = m_TempX = header.previous_x;
+  m_PreviousY = m_TempY = header.previous_y;
+
+  // Resize the buffers to fit the board size
+  ResizeBoard();
+
+  // Load players matched cards count
+  m_PlayersMatchedCardsCount.assign(view->GetMatchedCounts(),
+                                    view->GetMatchedCounts() + m_PlayersCount);
+
+  // Load board, widening narrow card ids, and masks, each a single copy of a
+  // contiguous section
+  view->CopyBoard(m_Board.data());
+  std::memcpy(m_HasCardBeenRevealed.GetPtr(), view->GetRevealedWords(),
+              view->GetMaskWords() * sizeof(std::uint64_t));
+  std::memcpy(m_HasCardBeenMatched.GetPtr(), view->GetMatchedWords(),
+              view->GetMaskWords() * sizeof(std::uint64_t));
+
+  PublishSnapshot(true);
+  RestartJournal();
+
+  return true;
 }
 
-void MemoryLogic::LoadState(const std::filesystem::path &filename) {
-  // Open file for reading in binary format
-  std::ifstream file(filename, std::ios::binary);
+bool MemoryLogic::LoadLegacyState(std::span<const std::byte> image,
+                                  std::string &error) {
+  std::size_t position = 0;
 
-  // If the file didn't open note and return
-  if (!file.is_open()) {
-    std::ofstream debug_stream("debug_output.txt",
-                               std::ios::app); // Debug output stream
+  // Read size bytes into destination, fails past the end of image
+  const auto read = [&](void *destination, std::size_t size) {
+    if (image.size() - position < size) {
+      return false;
+    }
 
-    debug_stream << "[MemoryLogic::SaveState] Unable to open file: " << filename
-                 << std::endl;
+    std::memcpy(destination, image.data() + position, size);
+    position += size;
+    return true;
+  };
 
-    debug_stream.close();
-    return;
+  std::uint32_t fields[6]{}; // Board size, game status, player count, player
+                             // index, previous x, previous y
+
+  if (!read(fields, sizeof(fields))) {
+    error = "Truncated legacy save file";
+    return false;
+  }
+
+  const auto [board_size, game_status, player_count, player_index, previous_x,
+              previous_y] = fields;
+
+  const std::size_t row_bytes = (static_cast<std::size_t>(board_size) + 7) / 8;
+  const std::size_t expected_size =
+      sizeof(fields) + player_count * sizeof(std::uint32_t) +
+      static_cast<std::size_t>(board_size) * (board_size + 2 * row_bytes);
+
+  if (board_size == 0 || board_size > kMaxSaveBoardSize ||
+      board_size % 2 != 0 || player_count == 0 ||
+      player_count > kMaxSavePlayerCount || game_status > 3 ||
+      player_index >= player_count ||
+      previous_x >= board_size || previous_y >= board_size ||
+      image.size() != expected_size) {
+    error = "Invalid legacy save file";
+    return false;
+  }
+
+  // Check the cards before changing anything, each row of cards is followed
+  // by the row's two masks
+  const std::size_t rows_offset =
+      sizeof(fields) + player_count * sizeof(std::uint32_t);
+  DealChecker deal(static_cast<std::uint64_t>(board_size) * board_size / 2,
+                   true);
+
+  for (std::uint32_t i = 0; i < board_size; i++) {
+    const std::byte *cards =
+        image.data() + rows_offset + i * (board_size + 2 * row_bytes);
+
+    for (std::uint32_t j = 0; j < board_size; j++) {
+      if (!deal.Add(static_cast<std::uint8_t>(
+              static_cast<std::uint8_t>(cards[j]) - 'A'))) {
+        error = "Invalid legacy save board";
+        return false;
+      }
+    }
   }
 
   // Load board state
-  file.read(reinterpret_cast<char *>(&m_BoardSize), sizeof(m_BoardSize));
-  file.read(reinterpret_cast<char *>(&m_GameStatus), sizeof(m_GameStatus));
-  file.read(reinterpret_cast<char *>(&m_PlayersCount), sizeof(m_PlayersCount));
-  file.read(reinterpret_cast<char *>(&m_PlayerIndex), sizeof(m_PlayerIndex));
+  m_BoardSize = board_size;
+  m_GameStatus = static_cast<GameStatus>(game_status);
+  m_PlayersCount = player_count;
+  m_PlayerIndex = player_index;
+  m_TurnNumber = 1; // Not stored in legacy saves
 
   // Load cursor state
-  file.read(reinterpret_cast<char *>(&m_PreviousX), sizeof(m_PreviousX));
-  file.read(reinterpret_cast<char *>(&m_PreviousY), sizeof(m_PreviousY));
-
-  // Fix Windows specific bug.
-  // If the vector's size was lower than m_BoardSize
-  // then, even after resizing it, it would only be able to store that old,
-  // smaller amount of data. Clearing the vector completely fixes this bug.
-  m_Board.clear();
-  m_HasCardBeenRevealed.clear();
-  m_HasCardBeenMatched.clear();
-  m_PlayersMatchedCardsCount.clear();
+  m_PreviousX = m_TempX = previous_x;
+  m_PreviousY = m_TempY = previous_y;
 
-  // Resize the vectors to fit the board size
-  m_Board.resize(m_BoardSize, std::vector<char>(m_BoardSize));
-  m_HasCardBeenRevealed.resize(m_BoardSize);
-  m_HasCardBeenMatched.resize(m_BoardSize);
+  // Resize the buffers to fit the board size
+  ResizeBoard();
 
   // Resize vector to fit number of players
-  m_PlayersMatchedCardsCount.resize(m_PlayersCount);
+  m_PlayersMatchedCardsCount.assign(m_PlayersCount, 0);
 
   // Load players matched cards count
-  file.read(reinterpret_cast<char *>(m_PlayersMatchedCardsCount.data()),
-            m_PlayersCount * sizeof(m_PlayersMatchedCardsCount[0]));
+  read(m_PlayersMatchedCardsCount.data(),
+       m_PlayersCount * sizeof(m_PlayersMatchedCardsCount[0]));
 
-  for (std::size_t i = 0; i < m_BoardSize; i++) {
-    // Resize the DynamicPackedBoolArray
-    m_HasCardBeenRevealed[i].Resize(m_BoardSize);
-    m_HasCardBeenMatched[i].Resize(m_BoardSize);
+  std::vector<std::uint8_t> row(row_bytes);
+  std::vector<std::uint8_t> cards(m_BoardSize);
 
-    // Load board
-    file.read(reinterpret_cast<char *>(m_Board[i].data()),
-              m_Board.size() * sizeof(m_Board[i][0]));
+  for (std::uint32_t i = 0; i < m_BoardSize; i++) {
+    // Load board, cards were stored as the character 'A' + id
+    read(cards.data(), cards.size());
+    for (std::uint32_t j = 0; j < m_BoardSize; j++) {
+      m_Board[CardIndex(i, j)] = static_cast<std::uint8_t>(cards[j] - 'A');
+    }
 
     // Load which cards should be revealed
-    file.read(reinterpret_cast<char *>(m_HasCardBeenRevealed[i].GetPtr()),
-              m_HasCardBeenRevealed[i].GetSizeInBytes());
+    read(row.data(), row.size());
+    UnpackMaskRow(m_HasCardBeenRevealed, m_BoardSize, i, row);
 
     // Load which cards are matched
-    file.read(reinterpret_cast<char *>(m_HasCardBeenMatched[i].GetPtr()),
-              m_HasCardBeenMatched[i].GetSizeInBytes());
+    read(row.data(), row.size());
+    UnpackMaskRow(m_HasCardBeenMatched, m_BoardSize, i, row);
   }
 
-  // Close file
-  file.close();
+  return true;
 }
 
 // Player with most matched cards
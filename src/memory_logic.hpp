@@ -1,18 +1,27 @@
 #pragma once
 
 // local
+#include <board_view.hpp>
+#include <card.hpp>
 #include <dynamic_packed_bool_array.hpp>
+#include <fast_rng.hpp>
 
 // std
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace memory_game {
 
+class MoveJournal;
+class SnapshotPublisher;
+
 // State at which the game is currently
 enum class GameStatus : std::uint32_t {
   selectingFirstCard,  // Selecting first card
@@ -30,9 +39,23 @@ public:
 
   MemoryLogic(std::uint32_t board_size, std::uint32_t player_count);
 
-  // Initialize random game board
+  // Allocate all game state from resource, e.g. a GameArena. The resource
+  // must outlive the game.
+  MemoryLogic(std::uint32_t board_size, std::uint32_t player_count,
+              std::pmr::memory_resource *resource);
+
+  // Initialize random game board using the engine's generator
   void InitializeBoard();
 
+  // Reseed the generator and initialize the board. Same seed, same board.
+  void InitializeBoard(std::uint64_t seed);
+
+  // Reseed the generator. Boards generated afterwards are reproducible.
+  void SetSeed(std::uint64_t seed) { m_Rng.Seed(seed); }
+
+  // Replace the generator used to shuffle boards
+  void SetRng(const Xoshiro256PlusPlus &rng) { m_Rng = rng; }
+
   // Set board size
   void SetBoardSize(std::uint32_t board_size);
 
@@ -46,23 +69,41 @@ public:
   // (On event enter) Select card at specified coordinates
   void SelectCard(std::uint32_t current_x, std::uint32_t current_y);
 
-  // Save current game state to file
-  void SaveState(const std::filesystem::path &filename);
+  // Record every new board and every move into journal from now on, nullptr
+  // stops recording. The journal starts from a snapshot of the current game
+  // and must outlive the recording. Copies of the game don't record.
+  void SetJournal(MoveJournal *journal);
+
+  // Publish a snapshot of the game to publisher after every transition from
+  // now on, starting with the current state, nullptr stops publishing. The
+  // publisher must outlive the game. Copies of the game don't publish.
+  void SetSnapshotPublisher(SnapshotPublisher *publisher);
+
+  // Save current game state to file (see save_format.hpp). Returns false if
+  // the file couldn't be written.
+  bool SaveState(const std::filesystem::path &filename) const;
+
+  // Write current game state into image in the save file format
+  void SerializeState(std::vector<std::byte> &image) const;
 
-  // Load game state from file
-  void LoadState(const std::filesystem::path &filename);
+  // Load game state from file. Returns false and keeps the current game if
+  // the file is missing, corrupted or not a save.
+  bool LoadState(const std::filesystem::path &filename);
 
-  // Return const board reference
-  const std::vector<std::vector<char>> &GetBoard() const { return m_Board; }
+  // Load game state from a save file image
+  bool LoadStateFromImage(std::span<const std::byte> image);
 
-  // Return const revealed cards reference
-  const std::vector<DynamicPackedBoolArray> &GetHasCardBeenRevealed() const {
-    return m_HasCardBeenRevealed;
+  // Return 2D view of the board
+  BoardView<CardId> GetBoard() const { return {m_Board.data(), m_BoardSize}; }
+
+  // Return 2D view of the revealed cards
+  PackedBoolBoardView GetHasCardBeenRevealed() const {
+    return {m_HasCardBeenRevealed, m_BoardSize};
   }
 
-  // Return const revealed reference
-  const std::vector<DynamicPackedBoolArray> &GetHasCardBeenMatched() const {
-    return m_HasCardBeenMatched;
+  // Return 2D view of the matched cards
+  PackedBoolBoardView GetHasCardBeenMatched() const {
+    return {m_HasCardBeenMatched, m_BoardSize};
   }
 
   // Return count of found pairs for current player
@@ -81,7 +122,19 @@ public:
 
   // Return total number of cards
   std::uint32_t GetTotalCardsCount() const {
-    return static_cast<std::uint32_t>(std::pow(m_BoardSize, 2));
+    return m_BoardSize * m_BoardSize;
+  }
+
+  // Return rows whose cards or masks changed since ClearDirtyRows, bit x is
+  // row x. A new or loaded board marks every row.
+  const DynamicPackedBoolArray &GetDirtyRows() const { return m_DirtyRows; }
+
+  // Mark every row as unchanged
+  void ClearDirtyRows() { m_DirtyRows.SetToZero(); }
+
+  // Return number of cards currently face down
+  std::uint32_t GetFaceDownCardsCount() const {
+    return static_cast<std::uint32_t>(m_HasCardBeenRevealed.CountUnset());
   }
 
   // Return game status
@@ -93,7 +146,26 @@ public:
   // Return current turn number
   std::uint32_t GetTurnNumber() const { return m_TurnNumber; }
 
+  // Set id the game's log records carry, 0 (the default) for none
+  void SetGameId(std::uint64_t game_id) { m_GameId = game_id; }
+
+  // Return id of the game in log records
+  std::uint64_t GetGameId() const { return m_GameId; }
+
 private: // Methods
+  // Select card without recording it in the journal
+  void ApplySelection(std::uint32_t current_x, std::uint32_t current_y);
+
+  // Deal a new shuffled board from m_Rng
+  void DealBoard();
+
+  // Restart the journal from a snapshot of the current game
+  void RestartJournal();
+
+  // Publish the current state if a publisher is attached. new_board says
+  // the card ids changed.
+  void PublishSnapshot(bool new_board);
+
   // Check if the selected cards match
   bool CheckMatch(std::uint32_t x1, std::uint32_t y1, std::uint32_t x2,
                   std::uint32_t y2) const;
@@ -101,16 +173,38 @@ private: // Methods
   // Reset board state
   void ResetState();
 
-private:                                    // Attributes
-  std::vector<std::vector<char>> m_Board{}; // 2D vector storing cards (chars)
+  // Resize the board buffers to m_BoardSize without freeing memory
+  void ResizeBoard();
+
+  // Load game state from image in the original headerless save format
+  bool LoadLegacyState(std::span<const std::byte> image, std::string &error);
+
+  // Mark row of card at flat index as changed
+  void MarkRowDirty(std::size_t index) {
+    m_DirtyRows.SetUnchecked(index / m_BoardSize, true);
+  }
+
+  // Return flat index of card at (x, y)
+  std::size_t CardIndex(std::uint32_t x, std::uint32_t y) const {
+    return static_cast<std::size_t>(x) * m_BoardSize + y;
+  }
+
+private: // Attributes
+  std::vector<CardId, CacheAlignedAllocator<CardId>>
+      m_Board{}; // Contiguous board storing card ids, indexed by
+                 // x * m_BoardSize + y
+
+  DynamicPackedBoolArray
+      m_HasCardBeenRevealed{}; // Bits storing which cards should be revealed,
+                               // indexed like m_Board
 
-  std::vector<DynamicPackedBoolArray>
-      m_HasCardBeenRevealed{}; // 2D (kinda) vector storing which cards should
-                               // be revealed
+  DynamicPackedBoolArray
+      m_HasCardBeenMatched{}; // Bits storing whether a card has been matched,
+                              // indexed like m_Board
 
-  std::vector<DynamicPackedBoolArray>
-      m_HasCardBeenMatched{}; // 2D (kinda) vector storing whether a card has
-                              // been matched
+  DynamicPackedBoolArray
+      m_DirtyRows{}; // Rows changed since ClearDirtyRows, for incremental
+                     // saving
 
   std::uint32_t m_BoardSize = 4; // Size of the board
 
@@ -129,12 +223,30 @@ private:                                    // Attributes
   std::uint32_t m_TempY = 0;
 
   std::uint32_t m_PlayersCount = 2; // Number of players
-  std::vector<std::uint32_t>
+  std::pmr::vector<std::uint32_t>
       m_PlayersMatchedCardsCount{}; // Vector storing number of matched cards
                                     // for each player
   std::uint32_t m_PlayerIndex = 0;  // Current players turn
 
   std::uint32_t m_TurnNumber = 1; // Current turn number
+
+  std::uint64_t m_GameId = 0; // Id in log records, 0 if none
+
+  Xoshiro256PlusPlus m_Rng{
+      FreshSeed()}; // Shuffles the board, seeded from hardware entropy
+
+  // Pointer that stays with its game, copies get nullptr
+  template <typename T> struct Link {
+    Link() = default;
+    Link(const Link &) {}
+    Link &operator=(const Link &) { return *this; }
+
+    T *target = nullptr;
+  };
+
+  Link<MoveJournal> m_Journal{}; // Journal recording this game, if any
+
+  Link<SnapshotPublisher> m_Publisher{}; // Publisher of snapshots, if any
 };
 
 } // namespace memory_game
\ No newline at end of file
@@ -5,15 +5,23 @@
 #include "common.hpp"
 #include "slider_with_callback.hpp"
 
+// libs
+// FTXUI includes
+#include <ftxui/component/loop.hpp>
+
 // std
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <ctime>
 #include <future>
 #include <iterator>
 #include <mutex>
 #include <random>
+#include <string>
+#include <system_error>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace memory_game {
@@ -21,9 +29,32 @@ namespace memory_game {
 MemoryUI::MemoryUI() {
   create_dir(m_SaveDir);
 
+  // Move save files from before the archive into it
+  m_SaveArchive.Import(m_SaveDir, true);
+  RefreshSaveList();
+
   m_Screen.SetCursor(ftxui::Screen::Cursor{
       .x = 0, .y = 0, .shape = ftxui::Screen::Cursor::Hidden});
 
+  // Resume the game autosaved before the last exit or crash
+  if (std::filesystem::exists(m_AutosavePath)) {
+    try {
+      m_pAutosave = std::make_unique<Autosave>(m_AutosavePath);
+
+      std::vector<std::byte> image{};
+      // Switching autosave off deletes the file, so it was on when this game
+      // was last played. Keep it on, the next crash must not lose the game.
+      if (m_pAutosave->ReadLatest(image) &&
+          m_pGameLogic->LoadStateFromImage(image)) {
+        m_Autosave = true;
+        m_BoardSize = m_pGameLogic->GetBoardSize();
+        MessageAndStyleFromGameState();
+      }
+    } catch (const std::system_error &) {
+      m_pAutosave.reset();
+    }
+  }
+
   m_PlayerCount = m_pGameLogic->GetPlayerCount();
 }
 
@@ -36,7 +67,7 @@ void MemoryUI::MainGame() {
                    &m_ShowOptions),
 
       ftxui::Maybe(GetLoadWindow() | ftxui::align_right | ftxui::vcenter,
-                   [&] { return m_SaveList.size() > 0; }),
+                   [&] { return !m_Saves.empty(); }),
 
       GetSaveWindow() | ftxui::vcenter,
 
@@ -49,8 +80,22 @@ void MemoryUI::MainGame() {
 
   main_game_component |= HandleGlobalEvents();
 
-  // Update/draw component in loop
-  m_Screen.Loop(main_game_component);
+  // Rebuild frames only when something changed
+  main_game_component =
+      RenderOnChange(std::move(main_game_component), &m_RenderScheduler);
+
+  // Read the highlighted save ahead of time
+  PrefetchSelectedSave(false);
+
+  // Update/draw component in loop. Every iteration waits for the next frame
+  // slot, then handles all events queued by then and draws once.
+  ftxui::Loop loop(&m_Screen, main_game_component);
+
+  while (!loop.HasQuitted()) {
+    m_RenderScheduler.WaitForFrame();
+    loop.RunOnceBlocking();
+    m_RenderScheduler.EndFrame();
+  }
 }
 
 // Handle game events and update game UI
@@ -61,16 +106,23 @@ ftxui::Component MemoryUI::GameBoardUI() const {
 // Handle global events (shortcuts)
 ftxui::ComponentDecorator MemoryUI::HandleGlobalEvents() {
   return ftxui::CatchEvent([this](ftxui::Event event) {
+    RefreshSaveList();
+
     if (event == ftxui::Event::Character('q')) {
       m_Screen.ExitLoopClosure()();
       return true;
     } else if (event == ftxui::Event::Character('r')) {
       m_pGameLogic->InitializeBoard();
+      ResetComputerPlayers();
       MessageAndStyleFromGameState();
+      AutosaveAsync();
       return true;
     } else if (event == ftxui::Event::Character('o')) {
       m_ShowOptions = !m_ShowOptions;
       return true;
+    } else if (event == ftxui::Event::Character('f')) {
+      m_ShowFrameStats = !m_ShowFrameStats;
+      return true;
     }
 
     return false;
@@ -101,10 +153,44 @@ ftxui::ComponentDecorator MemoryUI::HandleMemoryEvents() {
       return true;
     }
 
+    // Move by a whole view on boards larger than the screen
+    const auto rows =
+        static_cast<std::int32_t>(m_BoardRenderer.GetVisibleRows());
+    const auto columns =
+        static_cast<std::int32_t>(m_BoardRenderer.GetVisibleColumns());
+
+    if (event == ftxui::Event::PageUp) {
+      m_CurrentX -= std::max(rows, 1);
+      CheckBoundsXY();
+      return true;
+    }
+    if (event == ftxui::Event::PageDown) {
+      m_CurrentX += std::max(rows, 1);
+      CheckBoundsXY();
+      return true;
+    }
+    if (event == ftxui::Event::Home) {
+      m_CurrentY -= std::max(columns, 1);
+      CheckBoundsXY();
+      return true;
+    }
+    if (event == ftxui::Event::End) {
+      m_CurrentY += std::max(columns, 1);
+      CheckBoundsXY();
+      return true;
+    }
+
     if (event == ftxui::Event::Return) {
-      m_pGameLogic->SelectCard(m_CurrentX, m_CurrentY);
+      // Wait for the computer to move
+      if (m_ComputerPlayers.IsComputerTurn(*m_pGameLogic)) {
+        return true;
+      }
+
+      m_ComputerPlayers.SelectCard(*m_pGameLogic, m_CurrentX, m_CurrentY);
 
       MessageAndStyleFromGameState();
+      AutosaveAsync();
+      ScheduleComputerStep();
 
       return true;
     }
@@ -155,47 +241,38 @@ ftxui::Element MemoryUI::CreateUI() const {
           ftxui::separator(),
 
           ftxui::text(m_Message) | m_TextStyle,
+
+          m_ShowFrameStats
+              ? ftxui::hbox({ftxui::separator(), CreateFrameStats()})
+              : ftxui::emptyElement(),
       }) | ftxui::center,
       CreateBoard(m_CurrentX, m_CurrentY));
 }
 
-// Create gridbox of cards
-ftxui::Element MemoryUI::CreateBoard(const std::int32_t current_x,
-                                     const std::int32_t current_y) const {
-  std::vector<std::vector<ftxui::Element>> cells;
-  cells.resize(m_BoardSize, std::vector<ftxui::Element>(m_BoardSize));
-
-  for (int i = 0; i < m_BoardSize; ++i) {
-    for (int j = 0; j < m_BoardSize; ++j) {
-      ftxui::Element cell;
-      ftxui::Decorator color;
-
-      // Determine the content of the cell
-      if (m_pGameLogic->GetHasCardBeenRevealed()[i][j]) {
-        cell = ftxui::text(std::string(1, m_pGameLogic->GetBoard()[i][j]));
-        color = ftxui::color(ftxui::Color::White);
-      } else {
-        cell = ftxui::text("*");
-        color = ftxui::color(ftxui::Color::Grey50);
-      }
+// Create frame timing text
+ftxui::Element MemoryUI::CreateFrameStats() const {
+  const FrameStats &stats = m_RenderScheduler.GetStats();
 
-      // If the cell is the one user selected light it in blue
-      if (i == current_x && j == current_y) {
-        color = ftxui::color(ftxui::Color::Blue);
-      } else if (m_pGameLogic->GetHasCardBeenMatched()[i][j]) {
-        color = ftxui::color(ftxui::Color::Green);
-      }
+  const auto milliseconds = [](std::chrono::microseconds duration) {
+    return std::to_string(duration.count() / 1000) + "." +
+           std::to_string(duration.count() / 100 % 10) + " ms";
+  };
 
-      cell = cell | ftxui::bold | ftxui::center | ftxui::border | color |
-             ftxui::size(ftxui::WIDTH, ftxui::GREATER_THAN,
-                         std::ceil(60.0f / m_BoardSize)) |
-             ftxui::size(ftxui::HEIGHT, ftxui::GREATER_THAN,
-                         std::ceil(30.0f / m_BoardSize));
+  return ftxui::text("Frame " + milliseconds(stats.average_frame) +
+                     " (build " + milliseconds(stats.average_build) +
+                     ", max " + milliseconds(stats.max_frame) + "), " +
+                     std::to_string(stats.frames) + " built, " +
+                     std::to_string(stats.skipped) + " reused, " +
+                     std::to_string(stats.events) + " events") |
+         ftxui::color(ftxui::Color::Grey50);
+}
 
-      cells[i][j] = cell;
-    }
-  }
-  return ftxui::gridbox(cells) | ftxui::center;
+// Create gridbox of the cards that fit on the screen
+ftxui::Element MemoryUI::CreateBoard(const std::int32_t current_x,
+                                     const std::int32_t current_y) const {
+  // The window's border takes two lines and two columns
+  return m_BoardRenderer.Render(*m_pGameLogic, current_x, current_y,
+                                m_Screen.dimx() - 2, m_Screen.dimy() - 2);
 }
 
 // Update m_Message and m_TextStyle based on the game state
@@ -247,67 +324,247 @@ void MemoryUI::MessageAndStyleFromGameState() {
     m_TextStyle = ftxui::underlined | ftxui::color(ftxui::Color::LightYellow3);
     break;
   }
+
+  // Nothing to do but watch
+  if (m_ComputerPlayers.IsComputerTurn(*m_pGameLogic)) {
+    m_Message = "Computer is playing...";
+    m_TextStyle = ftxui::color(ftxui::Color::Grey50);
+  }
 }
 
-/* Components */
+// List new saves and resize the load window
+void MemoryUI::RefreshSaveList() {
+  m_SaveArchive.Refresh();
+
+  // Saves are only ever added, label just the new ones
+  for (const ArchiveEntry &entry :
+       m_SaveArchive.List(m_Saves.size(), m_SaveArchive.GetCount())) {
+    std::string label = get_human_readable_timestamp(
+        std::to_string(entry.timestamp));
+
+    // Tell saves of the same second apart
+    std::size_t same_time = 1;
+    for (auto it = m_Saves.rbegin();
+         it != m_Saves.rend() && it->timestamp == entry.timestamp; it++) {
+      same_time++;
+    }
+    if (same_time > 1) {
+      label += " (" + std::to_string(same_time) + ")";
+    }
 
-// Background
-ftxui::Component MemoryUI::GetBackgroundComponent() const {
-  // Mouse X and Y needed for dynamic background
-  float mouse_y = 0.0f;
-  float mouse_x = 0.0f;
+    m_Saves.push_back(entry);
+    m_SaveLabels.push_back(std::move(label));
+  }
 
-  auto background = ftxui::Renderer([&] {
-    // Scale to fit canvas 2x4 braille dot
-    std::uint32_t width = m_Screen.dimx() * 2;
-    std::uint32_t height = m_Screen.dimy() * 4;
+  const int save_count = static_cast<int>(m_Saves.size());
 
-    // Initialize dynamic canvas component
-    auto c = ftxui::Canvas(width, height);
+  m_LoadWindowHeight = save_count + 6;
+  m_SelectedSave = std::clamp(m_SelectedSave, 0, std::max(save_count - 1, 0));
+}
 
-    // Set size and transformation offset
-    std::uint32_t size = std::max(width, height);
-    std::int32_t offset = size;
+// Snapshot the game and append it to the save archive on the I/O worker
+void MemoryUI::SaveGameAsync() {
+  // Serializing is a few copies of contiguous buffers, cheap enough for the
+  // UI thread
+  auto image = std::make_shared<std::vector<std::byte>>();
+  m_pGameLogic->SerializeState(*image);
 
-    // Black magic math
-    float my = (mouse_y - offset) / -5.f;
-    float mx = (mouse_x - 3 * my + offset) / 5.f;
+  const std::int64_t timestamp = std::time(nullptr);
 
-    std::vector<std::vector<float>> ys(size, std::vector<float>(size));
+  m_IoWorker.Submit([this, image, timestamp] {
+    const bool saved = m_SaveArchive.Append(*image, timestamp);
 
-    for (int y = 0; y < size; y++) {
-      for (int x = 0; x < size; x++) {
-        float dx = x - mx;
-        float dy = y - my;
-        ys[y][x] = -1.5 + 3.0 * std::exp(-0.2f * (dx * dx + dy * dy));
+    PostToUI([this, saved] {
+      if (!saved) {
+        m_Message = "Unable to save the game";
+        m_TextStyle = ftxui::bold | ftxui::color(ftxui::Color::Red);
       }
-    }
-    for (int y = 0; y < size; y++) {
-      for (int x = 0; x < size; x++) {
-        if (x != 0) {
-          c.DrawPointLine(5 * (x - 1) + 3 * (y - 0) - offset,
-                          offset - 5 * (y - 0) - 5 * ys[y][x - 1],
-                          5 * (x - 0) + 3 * (y - 0) - offset,
-                          offset - 5 * (y - 0) - 5 * ys[y][x]);
-        }
-        if (y != 0) {
-          c.DrawPointLine(5 * (x - 0) + 3 * (y - 1) - offset,
-                          offset - 5 * (y - 1) - 5 * ys[y - 1][x],
-                          5 * (x - 0) + 3 * (y - 0) - offset,
-                          offset - 5 * (y - 0) - 5 * ys[y][x]);
-        }
+
+      RefreshSaveList();
+    });
+  });
+}
+
+// Write the game's changes to the autosave file on the I/O worker
+void MemoryUI::AutosaveAsync(bool force) {
+  if (!m_Autosave || (!force && !m_pGameLogic->GetDirtyRows().Any())) {
+    return;
+  }
+
+  // Only the changed rows reach the disk, the image is a cheap copy
+  auto image = std::make_shared<std::vector<std::byte>>();
+  m_pGameLogic->SerializeState(*image);
+  auto dirty_rows =
+      std::make_shared<DynamicPackedBoolArray>(m_pGameLogic->GetDirtyRows());
+  m_pGameLogic->ClearDirtyRows();
+
+  m_IoWorker.Submit([this, image, dirty_rows] {
+    bool saved = false;
+
+    try {
+      if (!m_pAutosave) {
+        m_pAutosave = std::make_unique<Autosave>(m_AutosavePath);
       }
+      saved = m_pAutosave->Commit(*image, *dirty_rows);
+    } catch (const std::system_error &) {
+      saved = false;
+    }
+
+    if (!saved) {
+      PostToUI([this] {
+        m_Message = "Unable to autosave the game";
+        m_TextStyle = ftxui::bold | ftxui::color(ftxui::Color::Red);
+      });
+    }
+  });
+}
+
+// Close and delete the autosave file on the I/O worker
+void MemoryUI::RemoveAutosaveAsync() {
+  m_IoWorker.Submit([this] {
+    m_pAutosave.reset();
+
+    std::error_code error{};
+    std::filesystem::remove(m_AutosavePath, error);
+  });
+}
+
+// Read the highlighted save on the I/O worker so loading it is instant
+void MemoryUI::PrefetchSelectedSave(bool load) {
+  if (m_SelectedSave < 0 ||
+      m_SelectedSave >= static_cast<int>(m_Saves.size())) {
+    return;
+  }
+
+  const std::uint64_t id = m_Saves[m_SelectedSave].id;
+
+  // Already read
+  if (id == m_PrefetchedId) {
+    if (load) {
+      LoadPrefetchedSave();
     }
+    return;
+  }
+
+  m_LoadWhenPrefetched = load;
+
+  // Already being read
+  if (id == m_RequestedId) {
+    return;
+  }
+
+  m_RequestedId = id;
+
+  m_IoWorker.Submit([this, id] {
+    auto image = std::make_shared<std::vector<std::byte>>();
+    const bool read = m_SaveArchive.Load(id, *image);
 
-    return ftxui::canvas(std::move(c));
+    PostToUI([this, id, image, read] {
+      // Another save was highlighted in the meantime
+      if (id != m_RequestedId) {
+        return;
+      }
+
+      m_RequestedId = 0;
+
+      if (!read) {
+        m_LoadWhenPrefetched = false;
+        return;
+      }
+
+      m_PrefetchedId = id;
+      m_PrefetchedImage = std::move(*image);
+
+      if (m_LoadWhenPrefetched) {
+        m_LoadWhenPrefetched = false;
+        LoadPrefetchedSave();
+      }
+    });
   });
+}
 
-  // Scale mouse coordinates and update variables
-  background |= ftxui::CatchEvent([&](ftxui::Event e) {
+// Load the save held in m_PrefetchedImage
+void MemoryUI::LoadPrefetchedSave() {
+  // A rejected save leaves the current game as it was
+  if (!m_pGameLogic->LoadStateFromImage(m_PrefetchedImage)) {
+    m_Message = "Unable to load the save";
+    m_TextStyle = ftxui::bold | ftxui::color(ftxui::Color::Red);
+    return;
+  }
+
+  m_BoardSize = m_pGameLogic->GetBoardSize();
+  CheckBoundsXY();
+
+  ResetComputerPlayers();
+  MessageAndStyleFromGameState();
+  AutosaveAsync();
+}
+
+// Seat computers in every player slot but the first if computer opponents
+// are on, and let them start over
+void MemoryUI::ResetComputerPlayers() {
+  for (std::uint32_t i = 0; i < m_pGameLogic->GetPlayerCount(); i++) {
+    m_ComputerPlayers.SetPolicy(i, i > 0 && m_ComputerOpponents
+                                       ? std::make_unique<OptimalPolicy>()
+                                       : nullptr);
+  }
+
+  m_ComputerPlayers.Reset(*m_pGameLogic, FreshSeed());
+
+  ScheduleComputerStep();
+}
+
+// Let the computer to move play its next step after a pause
+void MemoryUI::ScheduleComputerStep() {
+  if (m_ComputerStepPending ||
+      !m_ComputerPlayers.IsComputerTurn(*m_pGameLogic)) {
+    return;
+  }
+
+  m_ComputerStepPending = true;
+
+  m_ComputerWorker.Submit([this] {
+    // Slow enough for humans to follow the cards
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+
+    PostToUI([this] {
+      m_ComputerStepPending = false;
+
+      if (m_ComputerPlayers.PlayStep(*m_pGameLogic)) {
+        MessageAndStyleFromGameState();
+        AutosaveAsync();
+      }
+
+      ScheduleComputerStep();
+    });
+  });
+}
+
+// Run closure on the UI thread and redraw
+void MemoryUI::PostToUI(std::function<void()> closure) {
+  m_Screen.Post(std::move(closure));
+
+  // Closures don't trigger a redraw by themselves
+  m_Screen.PostEvent(ftxui::Event::Custom);
+}
+
+/* Components */
+
+// Background
+ftxui::Component MemoryUI::GetBackgroundComponent() const {
+  // Shared by the renderer and the event handler, keeps the cached surface
+  auto renderer = std::make_shared<BackgroundRenderer>();
+
+  auto background = ftxui::Renderer([this, renderer] {
+    // Scale to fit canvas 2x4 braille dot
+    return renderer->Render(m_Screen.dimx() * 2, m_Screen.dimy() * 4);
+  });
+
+  // Scale mouse coordinates and update the renderer
+  background |= ftxui::CatchEvent([renderer](ftxui::Event e) {
     if (e.is_mouse()) {
       if (e.mouse().x > 1 || e.mouse().y > 1) {
-        mouse_x = (e.mouse().x - 1) * 2;
-        mouse_y = (e.mouse().y - 1) * 4;
+        renderer->SetMouse((e.mouse().x - 1) * 2, (e.mouse().y - 1) * 4);
       }
     }
     return false;
@@ -318,6 +575,24 @@ ftxui::Component MemoryUI::GetBackgroundComponent() const {
 
 // Options window
 ftxui::Component MemoryUI::GetOptionsWindow() {
+  // Save the whole game when autosave is switched on, drop the file when it's
+  // switched off so it's never resumed
+  ftxui::CheckboxOption autosave_option = ftxui::CheckboxOption::Simple();
+  autosave_option.on_change = [&] {
+    if (m_Autosave) {
+      AutosaveAsync(true);
+    } else {
+      RemoveAutosaveAsync();
+    }
+  };
+
+  // Seat or unseat the computers right away
+  ftxui::CheckboxOption computer_option = ftxui::CheckboxOption::Simple();
+  computer_option.on_change = [&] {
+    ResetComputerPlayers();
+    MessageAndStyleFromGameState();
+  };
+
   auto options_window =
       ftxui::Window({
           .inner =
@@ -333,10 +608,12 @@ ftxui::Component MemoryUI::GetOptionsWindow() {
                                     static_cast<std::uint32_t>(board_size) * 2;
 
                                 m_pGameLogic->SetBoardSize(m_BoardSize);
+                                ResetComputerPlayers();
+                                AutosaveAsync();
                               },
                           .value = 2,
                           .min = 1,
-                          .max = 5,
+                          .max = 50,
                           .increment = 1,
                           .color_active = ftxui::Color::YellowLight,
                           .color_inactive = ftxui::Color::YellowLight,
@@ -355,6 +632,8 @@ ftxui::Component MemoryUI::GetOptionsWindow() {
                                           m_pGameLogic->SetPlayerCount(
                                               static_cast<std::uint32_t>(
                                                   player_count));
+                                          ResetComputerPlayers();
+                                          AutosaveAsync();
                                         },
                                     .value = &m_PlayerCount,
                                     .min = 1,
@@ -372,6 +651,15 @@ ftxui::Component MemoryUI::GetOptionsWindow() {
                   ftxui::Checkbox("Background", &m_AddBackground) |
                       ftxui::center | ftxui::color(ftxui::Color::Yellow),
 
+                  // Select whether to autosave after every move
+                  ftxui::Checkbox("Autosave", &m_Autosave, autosave_option) |
+                      ftxui::center | ftxui::color(ftxui::Color::Yellow),
+
+                  // Select whether players after the first are computers
+                  ftxui::Checkbox("Computer opponents", &m_ComputerOpponents,
+                                  computer_option) |
+                      ftxui::center | ftxui::color(ftxui::Color::Yellow),
+
                   ftxui::Renderer([] {
                     return ftxui::separator();
                   }), // Separate select button from options
@@ -385,7 +673,7 @@ ftxui::Component MemoryUI::GetOptionsWindow() {
           .title = "Options",
           .left = 0,
           .width = 34,
-          .height = 11,
+          .height = 13,
       });
 
   return options_window;
@@ -394,20 +682,7 @@ ftxui::Component MemoryUI::GetOptionsWindow() {
 // Save game window
 ftxui::Component MemoryUI::GetSaveWindow() {
   auto save_window = ftxui::Window({
-      .inner = ftxui::Button("Save",
-                             [&] {
-                               m_pGameLogic->SaveState(
-                                   m_SaveDir / get_timestamp_filename());
-
-                               m_ReadableSaveList =
-                                   get_human_readable_file_list(m_SaveDir);
-                               m_SaveList = get_file_list(m_SaveDir);
-
-                               m_LoadWindowHeight =
-                                   static_cast<int>(m_SaveList.size()) + 6;
-
-                               MessageAndStyleFromGameState();
-                             }) |
+      .inner = ftxui::Button("Save", [&] { SaveGameAsync(); }) |
                ftxui::center | ftxui::flex | ftxui::color(ftxui::Color::Cyan),
 
       .title = "Save game",
@@ -420,20 +695,16 @@ ftxui::Component MemoryUI::GetSaveWindow() {
 
 // Load save window
 ftxui::Component MemoryUI::GetLoadWindow() {
-  // Load selected save
-  auto load_select = [&] {
-    m_pGameLogic->LoadState(m_SaveList[m_SelectedSave]);
-
-    m_BoardSize = m_pGameLogic->GetBoardSize();
-
-    MessageAndStyleFromGameState();
-  };
+  // Load selected save, it's usually already read ahead
+  auto load_select = [&] { PrefetchSelectedSave(true); };
 
   // Menu to select save to load
   ftxui::MenuOption menu_load_option;
   menu_load_option.on_enter = load_select;
+  menu_load_option.on_change = [&] { PrefetchSelectedSave(false); };
 
-  auto menu_load = Menu(&m_ReadableSaveList, &m_SelectedSave, menu_load_option);
+  auto menu_load =
+      Menu(&m_SaveLabels, &m_SelectedSave, menu_load_option);
 
   auto load_window = ftxui::Window({
       .inner = ftxui::Container::Vertical({
@@ -463,6 +734,13 @@ ftxui::Component MemoryUI::GetShortcutsWindow() {
                          ftxui::text("o - Open/hide options") | ftxui::flex,
                          ftxui::filler(),
                          ftxui::text("r - Reset the board state") | ftxui::flex,
+                         ftxui::filler(),
+                         ftxui::text("f - Show frame timing") | ftxui::flex,
+                         ftxui::filler(),
+                         ftxui::text("PgUp/PgDn - Scroll rows") | ftxui::flex,
+                         ftxui::filler(),
+                         ftxui::text("Home/End - Scroll columns") |
+                             ftxui::flex,
                          ftxui::separator(),
                      });
                    }),
@@ -474,7 +752,7 @@ ftxui::Component MemoryUI::GetShortcutsWindow() {
 
       .title = "Shortcuts",
       .width = 28,
-      .height = 9,
+      .height = 13,
   });
 }
 
@@ -1,8 +1,16 @@
 #pragma once
 
 // local
+#include "autosave.hpp"
+#include "background_renderer.hpp"
+#include "background_worker.hpp"
+#include "board_renderer.hpp"
 #include "common.hpp"
+#include "computer_players.hpp"
 #include "memory_logic.hpp"
+#include "optimal_policy.hpp"
+#include "render_scheduler.hpp"
+#include "save_archive.hpp"
 
 // libs
 // FTXUI includes
@@ -14,10 +22,13 @@
 
 // std
 #include <cstdint>
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace memory_game {
 
@@ -45,13 +56,47 @@ private: // Methods
   // Create static UI game element
   ftxui::Element CreateUI() const;
 
-  // Create gridbox of cards
+  // Create frame timing text
+  ftxui::Element CreateFrameStats() const;
+
+  // Create gridbox of the cards that fit on the screen
   ftxui::Element CreateBoard(const std::int32_t current_x,
                              const std::int32_t current_y) const;
 
   // Update m_Message and m_TextStyle based on the game state
   void MessageAndStyleFromGameState();
 
+  // List saves added since the last call, also by other processes, and
+  // resize the load window
+  void RefreshSaveList();
+
+  // Snapshot the game and append it to the save archive on the I/O worker
+  void SaveGameAsync();
+
+  // Write the game's changes to the autosave file on the I/O worker if
+  // autosave is on. Does nothing if nothing changed, unless force is true.
+  void AutosaveAsync(bool force = false);
+
+  // Close and delete the autosave file on the I/O worker
+  void RemoveAutosaveAsync();
+
+  // Read the highlighted save on the I/O worker so loading it is instant.
+  // If load is true the save is loaded as soon as it has been read.
+  void PrefetchSelectedSave(bool load);
+
+  // Load the save held in m_PrefetchedImage
+  void LoadPrefetchedSave();
+
+  // Seat computers in every player slot but the first if computer opponents
+  // are on, and let them start over
+  void ResetComputerPlayers();
+
+  // Let the computer to move play its next step after a pause
+  void ScheduleComputerStep();
+
+  // Run closure on the UI thread and redraw. Safe to call from any thread.
+  void PostToUI(std::function<void()> closure);
+
   // Components
   // Background
   ftxui::Component GetBackgroundComponent() const;
@@ -78,9 +123,21 @@ private: // Attributes
   // Add background
   bool m_AddBackground = false;
 
+  // Autosave after every move
+  bool m_Autosave = false;
+
+  // Players after the first are computers
+  bool m_ComputerOpponents = false;
+
+  // A computer step is queued on m_ComputerWorker
+  bool m_ComputerStepPending = false;
+
   // Show shortcuts window
   bool m_ShowShortcuts = true;
 
+  // Show frame timing in the header
+  bool m_ShowFrameStats = false;
+
   // Player count
   std::int32_t m_PlayerCount;
 
@@ -89,13 +146,26 @@ private: // Attributes
 
   const std::filesystem::path m_SaveDir = "saves/"; // Where saves are stored
 
-  // Get saves
-  std::vector<std::string> m_ReadableSaveList =
-      get_human_readable_file_list(m_SaveDir);
-  std::vector<std::filesystem::path> m_SaveList = get_file_list(m_SaveDir);
+  // Pack holding every save
+  SaveArchive m_SaveArchive{m_SaveDir / "saves.pack"};
+
+  // Saves of m_SaveArchive and their labels, oldest first
+  std::vector<ArchiveEntry> m_Saves{};
+  std::vector<std::string> m_SaveLabels{};
 
   // Load window height
-  int m_LoadWindowHeight = static_cast<int>(m_SaveList.size()) + 6;
+  int m_LoadWindowHeight = 6;
+
+  // Save read ahead by PrefetchSelectedSave, id 0 if none (ids are record
+  // offsets, never 0)
+  std::uint64_t m_PrefetchedId = 0;
+  std::vector<std::byte> m_PrefetchedImage{};
+
+  // Save currently being read by the I/O worker, 0 if none
+  std::uint64_t m_RequestedId = 0;
+
+  // Load the requested save once it has been read
+  bool m_LoadWhenPrefetched = false;
 
   std::string m_Message = "Select first card"; // Status message
 
@@ -105,7 +175,30 @@ private: // Attributes
 
   ftxui::ScreenInteractive m_Screen = ftxui::ScreenInteractive::Fullscreen();
 
+  // Coalesces events into frames and skips rebuilding unchanged ones
+  RenderScheduler m_RenderScheduler{};
+
+  // Cached board elements, updated while rendering
+  mutable BoardRenderer m_BoardRenderer{};
+
   // Handle the game logic
   std::unique_ptr<MemoryLogic> m_pGameLogic = std::make_unique<MemoryLogic>();
+
+  const std::filesystem::path m_AutosavePath =
+      "autosave.dat"; // Kept out of m_SaveDir, it isn't a regular save
+
+  // Autosave file, opened on first use. Only the I/O worker touches it once
+  // the UI runs.
+  std::unique_ptr<Autosave> m_pAutosave{};
+
+  // Computer players, every selection goes through them
+  ComputerPlayers m_ComputerPlayers{};
+
+  // Paces the computer players' steps
+  BackgroundWorker m_ComputerWorker{};
+
+  // Runs save and load file I/O. Declared last so it is destroyed first and
+  // finishes pending saves while everything it uses is still alive.
+  BackgroundWorker m_IoWorker{};
 };
 } // namespace memory_game
\ No newline at end of file
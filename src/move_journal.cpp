@@ -0,0 +1,322 @@
+// header
+#include "move_journal.hpp"
+
+// local
+#include "common.hpp"
+#include "save_format.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace memory_game {
+
+namespace {
+
+// Round size up to a multiple of 8 bytes
+constexpr std::size_t Align8(std::size_t size) { return (size + 7) / 8 * 8; }
+
+// Header bytes covered by header_crc
+constexpr std::size_t kHeaderCrcSize = offsetof(JournalHeader, header_crc);
+
+// Longest LEB128 encoding of a 32 bit value
+constexpr std::size_t kMaxValueBytes = 5;
+
+} // namespace
+
+/* MoveJournal::Cursor */
+
+bool MoveJournal::Cursor::Next(JournalMove &move) {
+  std::uint32_t value = 0;
+
+  for (std::size_t i = 0; i < kMaxValueBytes; i++) {
+    if (m_Offset >= m_Moves.size()) {
+      return false;
+    }
+
+    const std::uint8_t byte = m_Moves[m_Offset++];
+    value |= static_cast<std::uint32_t>(byte & 0x7F) << (7 * i);
+
+    if ((byte & 0x80) == 0) {
+      move.hide = value == 0;
+      move.index = move.hide ? 0 : value - 1;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* MoveJournal */
+
+void MoveJournal::Begin(std::uint32_t board_size, std::uint32_t player_count,
+                        std::uint64_t seed) {
+  m_BoardSize = board_size;
+  m_PlayerCount = player_count;
+  m_Seed = seed;
+  m_Snapshot.clear();
+
+  m_Moves.clear();
+  m_MoveCount = 0;
+}
+
+void MoveJournal::BeginFromSnapshot(std::vector<std::byte> image) {
+  const auto &header = *reinterpret_cast<const SaveHeader *>(image.data());
+
+  m_BoardSize = header.board_size;
+  m_PlayerCount = header.player_count;
+  m_Seed = 0;
+  m_Snapshot = std::move(image);
+
+  m_Moves.clear();
+  m_MoveCount = 0;
+}
+
+void MoveJournal::AppendSelect(std::uint32_t index) { AppendValue(index + 1); }
+
+void MoveJournal::AppendHide() { AppendValue(0); }
+
+void MoveJournal::AppendValue(std::uint32_t value) {
+  while (value >= 0x80) {
+    m_Moves.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  m_Moves.push_back(static_cast<std::uint8_t>(value));
+
+  m_MoveCount++;
+}
+
+bool MoveJournal::Restore(MemoryLogic &logic) const {
+  if (!m_Snapshot.empty()) {
+    return logic.LoadStateFromImage(m_Snapshot);
+  }
+
+  logic.SetPlayerCount(m_PlayerCount);
+  logic.SetBoardSize(m_BoardSize);
+  logic.InitializeBoard(m_Seed);
+
+  return true;
+}
+
+void MoveJournal::Serialize(std::vector<std::byte> &image) const {
+  const std::size_t body_offset = sizeof(JournalHeader);
+  const std::size_t moves_offset = body_offset + Align8(m_Snapshot.size());
+
+  image.assign(moves_offset + m_Moves.size(), std::byte{0});
+
+  std::memcpy(image.data() + body_offset, m_Snapshot.data(), m_Snapshot.size());
+  std::memcpy(image.data() + moves_offset, m_Moves.data(), m_Moves.size());
+
+  JournalHeader header{};
+  std::memcpy(header.magic, kJournalMagic, sizeof(kJournalMagic));
+  header.version = kJournalVersion;
+  header.board_size = m_BoardSize;
+  header.player_count = m_PlayerCount;
+  header.flags = m_Snapshot.empty() ? 0 : kJournalFromSnapshot;
+  header.seed = m_Seed;
+  header.snapshot_size = m_Snapshot.size();
+  header.move_count = m_MoveCount;
+  header.moves_size = m_Moves.size();
+  header.body_crc =
+      Crc32(std::span<const std::byte>(image).subspan(body_offset));
+
+  std::memcpy(image.data(), &header, sizeof(header));
+
+  header.header_crc =
+      Crc32(std::span<const std::byte>(image).first(kHeaderCrcSize));
+  std::memcpy(image.data(), &header, sizeof(header));
+}
+
+bool MoveJournal::Parse(std::span<const std::byte> image, std::string &error) {
+  JournalHeader header{};
+
+  if (image.size() < sizeof(header) ||
+      std::memcmp(image.data(), kJournalMagic, sizeof(kJournalMagic)) != 0) {
+    error = "Not a journal file";
+    return false;
+  }
+
+  std::memcpy(&header, image.data(), sizeof(header));
+
+  if (header.version != kJournalVersion) {
+    error = "Unsupported journal version " + std::to_string(header.version);
+    return false;
+  }
+
+  if (Crc32(image.first(kHeaderCrcSize)) != header.header_crc) {
+    error = "Corrupted journal header";
+    return false;
+  }
+
+  const bool from_snapshot = (header.flags & kJournalFromSnapshot) != 0;
+
+  // Seeded boards are dealt in pairs
+  if (header.board_size == 0 || header.board_size > kMaxSaveBoardSize ||
+      header.player_count == 0 || header.player_count > kMaxSavePlayerCount ||
+      (header.flags & ~kJournalFromSnapshot) != 0 ||
+      from_snapshot != (header.snapshot_size != 0) ||
+      (!from_snapshot && header.board_size % 2 != 0)) {
+    error = "Invalid journal header values";
+    return false;
+  }
+
+  const std::span<const std::byte> body = image.subspan(sizeof(header));
+
+  if (header.snapshot_size > body.size() ||
+      Align8(header.snapshot_size) + header.moves_size != body.size()) {
+    error = "Truncated journal file";
+    return false;
+  }
+
+  if (Crc32(body) != header.body_crc) {
+    error = "Corrupted journal body";
+    return false;
+  }
+
+  // The snapshot is copied first, the save view needs it 8 byte aligned
+  std::vector<std::byte> snapshot(body.begin(),
+                                  body.begin() + header.snapshot_size);
+
+  if (from_snapshot) {
+    const std::optional<SaveView> view = SaveView::Parse(snapshot, error);
+    if (!view) {
+      return false;
+    }
+
+    if (view->GetHeader().board_size != header.board_size ||
+        view->GetHeader().player_count != header.player_count) {
+      error = "Journal snapshot doesn't match the journal";
+      return false;
+    }
+  }
+
+  const std::span<const std::byte> moves =
+      body.subspan(Align8(header.snapshot_size));
+  const auto *move_bytes = reinterpret_cast<const std::uint8_t *>(moves.data());
+
+  // Check every move once, so replays can trust the journal
+  const std::uint64_t cards =
+      static_cast<std::uint64_t>(header.board_size) * header.board_size;
+
+  Cursor cursor({move_bytes, moves.size()}, 0);
+  std::uint64_t move_count = 0;
+
+  for (JournalMove move{}; cursor.Next(move); move_count++) {
+    if (!move.hide && move.index >= cards) {
+      error = "Journal move outside the board";
+      return false;
+    }
+  }
+
+  if (cursor.GetOffset() != moves.size() || move_count != header.move_count) {
+    error = "Invalid journal moves";
+    return false;
+  }
+
+  m_BoardSize = header.board_size;
+  m_PlayerCount = header.player_count;
+  m_Seed = header.seed;
+  m_Snapshot = std::move(snapshot);
+  m_Moves.assign(move_bytes, move_bytes + moves.size());
+  m_MoveCount = header.move_count;
+
+  return true;
+}
+
+bool MoveJournal::Save(const std::filesystem::path &filename) const {
+  std::vector<std::byte> image{};
+  Serialize(image);
+
+  return write_file_atomically(filename, image);
+}
+
+bool MoveJournal::Load(const std::filesystem::path &filename) {
+  std::vector<std::byte> image{};
+  std::string error{};
+
+  return read_file(filename, image) && Parse(image, error);
+}
+
+void ApplyMove(MemoryLogic &logic, const JournalMove &move) {
+  if (move.hide) {
+    // Snapshots store mismatched cards as already hidden, then there is
+    // nothing left to hide
+    if (logic.GetGameStatus() == GameStatus::cardsDidntMatch) {
+      logic.SelectCard(0, 0);
+    }
+    return;
+  }
+
+  logic.SelectCard(move.index / logic.GetBoardSize(),
+                   move.index % logic.GetBoardSize());
+}
+
+/* JournalReplay */
+
+JournalReplay::JournalReplay(const MoveJournal &journal,
+                             std::size_t snapshot_interval)
+    : m_Journal(journal) {
+  snapshot_interval = std::max<std::size_t>(snapshot_interval, 1);
+
+  MemoryLogic logic{};
+  if (!m_Journal.Restore(logic)) {
+    return;
+  }
+
+  MoveJournal::Cursor cursor = m_Journal.GetCursor();
+  std::size_t move = 0;
+  std::size_t next_snapshot = 0;
+
+  for (;;) {
+    // A pending mismatch is lost in a snapshot, the next move takes it
+    if (move >= next_snapshot &&
+        logic.GetGameStatus() != GameStatus::cardsDidntMatch) {
+      Snapshot &snapshot =
+          m_Snapshots.emplace_back(Snapshot{move, cursor.GetOffset(), {}});
+      logic.SerializeState(snapshot.image);
+
+      next_snapshot = move + snapshot_interval;
+    }
+
+    JournalMove next{};
+    if (!cursor.Next(next)) {
+      break;
+    }
+
+    ApplyMove(logic, next);
+    move++;
+  }
+
+  m_Valid = true;
+}
+
+bool JournalReplay::Seek(std::size_t move_count, MemoryLogic &logic) const {
+  if (!m_Valid) {
+    return false;
+  }
+
+  move_count = std::min(move_count, GetMoveCount());
+
+  // Last snapshot at or before move_count, the first one is at move 0
+  const auto it = std::prev(std::upper_bound(
+      m_Snapshots.begin(), m_Snapshots.end(), move_count,
+      [](std::size_t move, const Snapshot &snapshot) {
+        return move < snapshot.move;
+      }));
+
+  if (!logic.LoadStateFromImage(it->image)) {
+    return false;
+  }
+
+  MoveJournal::Cursor cursor = m_Journal.GetCursor(it->offset);
+
+  JournalMove move{};
+  for (std::size_t i = it->move; i < move_count && cursor.Next(move); i++) {
+    ApplyMove(logic, move);
+  }
+
+  return true;
+}
+
+} // namespace memory_game
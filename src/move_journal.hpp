@@ -0,0 +1,192 @@
+/*
+ *
+ * Move journal, version 1.
+ *
+ * A journal records how a game started (the seed the board was dealt from,
+ * or a full snapshot for games loaded from a save) followed by every card
+ * selection that changed the game. Replaying it reproduces the game exactly,
+ * which makes it useful for autosave, bug reports and analytics without
+ * storing board copies.
+ *
+ * Each move is an unsigned LEB128 number: 0 hides mismatched cards, n selects
+ * card n - 1 (index x * size + y). Boards up to 11x11 take one byte per move,
+ * boards up to 128x128 two.
+ *
+ * File layout, all integers little endian:
+ *   offset  size  field
+ *        0     8  magic "MEMJRNL\0"
+ *        8     4  format version (1)
+ *       12     4  board size
+ *       16     4  player count
+ *       20     4  flags, bit 0: starts from a snapshot instead of a seed
+ *       24     8  seed
+ *       32     8  snapshot size in bytes (save format image, 0 if none)
+ *       40     8  move count
+ *       48     8  moves size in bytes
+ *       56     4  CRC-32 of the body
+ *       60     4  CRC-32 of header bytes 0..59
+ *       64        snapshot, zero padded to a multiple of 8 bytes, then moves
+ *
+ */
+
+#pragma once
+
+// local
+#include "memory_logic.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory_game {
+
+// Magic at the start of every journal file
+inline constexpr char kJournalMagic[8] = {'M', 'E', 'M', 'J',
+                                          'R', 'N', 'L', '\0'};
+
+// Current journal format version
+inline constexpr std::uint32_t kJournalVersion = 1;
+
+// Journal file header, see the layout above
+struct JournalHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t board_size;
+  std::uint32_t player_count;
+  std::uint32_t flags;
+  std::uint64_t seed;
+  std::uint64_t snapshot_size;
+  std::uint64_t move_count;
+  std::uint64_t moves_size;
+  std::uint32_t body_crc;
+  std::uint32_t header_crc;
+};
+
+static_assert(sizeof(JournalHeader) == 64, "Journal header must be 64 bytes");
+
+// Journal starts from a snapshot instead of a seed
+inline constexpr std::uint32_t kJournalFromSnapshot = 1;
+
+// One recorded move
+struct JournalMove {
+  bool hide = false;       // Hide mismatched cards, index is unused
+  std::uint32_t index = 0; // Selected card, x * size + y
+};
+
+// Append-only record of one game
+class MoveJournal {
+public:
+  // Sequential decoder of the recorded moves
+  class Cursor {
+  public:
+    // Decode next move, returns false at the end
+    bool Next(JournalMove &move);
+
+    // Return byte offset of the next move
+    std::size_t GetOffset() const { return m_Offset; }
+
+  private:
+    friend class MoveJournal;
+
+    Cursor(std::span<const std::uint8_t> moves, std::size_t offset)
+        : m_Moves(moves), m_Offset(offset) {}
+
+    std::span<const std::uint8_t> m_Moves;
+    std::size_t m_Offset;
+  };
+
+  // Start a new journal for a board dealt from seed
+  void Begin(std::uint32_t board_size, std::uint32_t player_count,
+             std::uint64_t seed);
+
+  // Start a new journal from a valid game state image
+  // (MemoryLogic::SerializeState)
+  void BeginFromSnapshot(std::vector<std::byte> image);
+
+  // Record selection of card at index
+  void AppendSelect(std::uint32_t index);
+
+  // Record hiding of mismatched cards
+  void AppendHide();
+
+  // Return number of recorded moves
+  std::size_t GetMoveCount() const { return m_MoveCount; }
+
+  // Return size of the encoded moves in bytes
+  std::size_t GetMovesSize() const { return m_Moves.size(); }
+
+  // Return cursor at the first move, or at byte offset of a move
+  Cursor GetCursor(std::size_t offset = 0) const {
+    return Cursor(m_Moves, offset);
+  }
+
+  // Put logic into the state the journal starts from. Returns false if the
+  // snapshot can't be loaded.
+  bool Restore(MemoryLogic &logic) const;
+
+  // Write journal in the file format
+  void Serialize(std::vector<std::byte> &image) const;
+
+  // Replace journal with a parsed file image. Returns false and sets error if
+  // it isn't a valid journal.
+  bool Parse(std::span<const std::byte> image, std::string &error);
+
+  // Write journal file atomically. Returns false if it couldn't be written.
+  bool Save(const std::filesystem::path &filename) const;
+
+  // Read journal file. Returns false and keeps the current journal if it
+  // can't be read.
+  bool Load(const std::filesystem::path &filename);
+
+private:
+  // Append move value as LEB128
+  void AppendValue(std::uint32_t value);
+
+  std::uint32_t m_BoardSize = 0;
+  std::uint32_t m_PlayerCount = 0;
+  std::uint64_t m_Seed = 0;
+  std::vector<std::byte> m_Snapshot{}; // Empty if the game starts from m_Seed
+
+  std::vector<std::uint8_t> m_Moves{}; // LEB128 encoded moves
+  std::size_t m_MoveCount = 0;
+};
+
+// Apply recorded move to logic
+void ApplyMove(MemoryLogic &logic, const JournalMove &move);
+
+// Seekable replay of a journal.
+//
+// One pass over the journal at construction stores a snapshot of the game
+// every snapshot_interval moves. Seeking binary searches the snapshots and
+// replays at most about snapshot_interval moves from the nearest one, so it
+// costs O(log n) plus a bounded replay however long the game is.
+class JournalReplay {
+public:
+  explicit JournalReplay(const MoveJournal &journal,
+                         std::size_t snapshot_interval = 64);
+
+  // Return number of moves in the journal
+  std::size_t GetMoveCount() const { return m_Journal.GetMoveCount(); }
+
+  // Put logic into the state after the first move_count moves (clamped to the
+  // journal). logic must not be recording into a journal. Returns false if
+  // the journal's start can't be restored.
+  bool Seek(std::size_t move_count, MemoryLogic &logic) const;
+
+private:
+  struct Snapshot {
+    std::size_t move;        // Moves applied before the snapshot
+    std::size_t offset;      // Byte offset of the next move
+    std::vector<std::byte> image;
+  };
+
+  const MoveJournal &m_Journal;
+  std::vector<Snapshot> m_Snapshots{}; // Sorted by move
+  bool m_Valid = false;
+};
+
+} // namespace memory_game
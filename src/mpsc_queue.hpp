@@ -0,0 +1,95 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace memory_game {
+
+// Unbounded lock-free queue with many producers and a single consumer
+// (Vyukov's intrusive MPSC queue). Push is one atomic exchange, so producers
+// never wait for each other or for the consumer.
+//
+// Pop may briefly report an empty queue while a producer is between its
+// exchange and its link store. The consumer sees the item on its next Pop.
+template <typename T> class MpscQueue {
+public:
+  MpscQueue() : m_Head(&m_Stub), m_Tail(&m_Stub) {}
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // Free items that were never popped
+  ~MpscQueue() {
+    while (Pop()) {
+    }
+  }
+
+  // Add value to the queue. Safe to call from any thread.
+  void Push(T value) {
+    Node *node = new Node{std::move(value)};
+    Node *previous = m_Head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Remove the oldest value. Only the consumer thread may call this.
+  std::optional<T> Pop() {
+    Node *tail = m_Tail;
+    Node *next = tail->next.load(std::memory_order_acquire);
+
+    // Skip the stub node
+    if (tail == &m_Stub) {
+      if (next == nullptr) {
+        return std::nullopt;
+      }
+
+      m_Tail = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next != nullptr) {
+      m_Tail = next;
+      return Take(tail);
+    }
+
+    // tail is the last node, a producer may be linking a new one after it
+    if (tail != m_Head.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+
+    // Put the stub back behind the last node so it can be taken
+    m_Stub.next.store(nullptr, std::memory_order_relaxed);
+    Node *previous = m_Head.exchange(&m_Stub, std::memory_order_acq_rel);
+    previous->next.store(&m_Stub, std::memory_order_release);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return std::nullopt;
+    }
+
+    m_Tail = next;
+    return Take(tail);
+  }
+
+private:
+  struct Node {
+    std::optional<T> value{};
+    std::atomic<Node *> next{nullptr};
+  };
+
+  // Move value out of node and free it
+  static std::optional<T> Take(Node *node) {
+    std::optional<T> value = std::move(node->value);
+    delete node;
+    return value;
+  }
+
+  Node m_Stub{}; // Placeholder keeping the list non-empty
+
+  std::atomic<Node *> m_Head; // Last pushed node, written by producers
+  Node *m_Tail;               // Next node to pop, owned by the consumer
+};
+
+} // namespace memory_game
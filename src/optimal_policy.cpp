@@ -0,0 +1,220 @@
+// header
+#include "optimal_policy.hpp"
+
+// std
+#include <algorithm>
+#include <mutex>
+
+namespace memory_game {
+
+namespace {
+
+// Smallest improvement that changes a decision, keeps ties on the plain
+// unseen, unseen turn
+constexpr double kEpsilon = 1e-12;
+
+} // namespace
+
+/* OptimalPlaySolver */
+
+OptimalPlaySolver::OptimalPlaySolver(std::uint32_t card_count)
+    : m_CardCount(card_count - card_count % 2) {
+  const std::uint32_t cards = m_CardCount;
+
+  m_RowOffsets.resize(cards + 2);
+  for (std::uint32_t unseen = 0; unseen <= cards; unseen++) {
+    m_RowOffsets[unseen + 1] =
+        m_RowOffsets[unseen] + (MaxSingletons(unseen) - unseen % 2) / 2 + 1;
+  }
+  m_Decisions.assign(m_RowOffsets[cards + 1], 0);
+
+  // Values of the rows with unseen - 2, unseen - 1 and unseen cards, indexed
+  // by singletons
+  std::vector<double> before_last(cards + 3, 0.0);
+  std::vector<double> last(cards + 3, 0.0);
+  std::vector<double> current(cards + 3, 0.0);
+
+  for (std::uint32_t unseen = 1; unseen <= cards; unseen++) {
+    const double u = unseen;
+
+    for (std::uint32_t singletons = unseen % 2;
+         singletons <= MaxSingletons(unseen); singletons += 2) {
+      const double k = singletons;
+      std::uint8_t decision = 0;
+
+      // Turn an unseen card first. It matches a singleton with chance k / u,
+      // the player takes the pair and goes on.
+      double unseen_first = 0.0;
+      if (singletons > 0) {
+        unseen_first += k / u * (1.0 + last[singletons - 1]);
+      }
+
+      if (unseen > singletons) {
+        const double rest = u - 1.0;
+
+        // Then another unseen card: a pair, the partner of a singleton (the
+        // next player takes that pair) or a new card
+        double second = (1.0 + before_last[singletons]) / rest -
+                        k / rest * (1.0 + before_last[singletons]) -
+                        (u - 2.0 - k) / rest * before_last[singletons + 2];
+
+        // Or a singleton, which shows the next player nothing new
+        if (singletons > 0 && -last[singletons + 1] > second + kEpsilon) {
+          second = -last[singletons + 1];
+          decision |= kSingletonSecond;
+        }
+
+        unseen_first += (u - k) / u * second;
+      }
+
+      double best = unseen_first;
+
+      // Turn a singleton first, then an unseen card: its partner, another
+      // singleton's partner or a new card
+      if (singletons > 0) {
+        const double singleton_first =
+            (1.0 + last[singletons - 1]) / u -
+            (k - 1.0) / u * (1.0 + last[singletons - 1]) -
+            (u - k) / u * last[singletons + 1];
+
+        if (singleton_first > best + kEpsilon) {
+          best = singleton_first;
+          decision |= kSingletonFirst;
+        }
+      }
+
+      current[singletons] = best;
+      m_Decisions[m_RowOffsets[unseen] + singletons / 2] = decision;
+    }
+
+    before_last.swap(last);
+    last.swap(current);
+  }
+
+  m_ExpectedMargin = cards == 0 ? 0.0 : last[0];
+}
+
+std::uint8_t OptimalPlaySolver::GetDecision(std::uint32_t unseen,
+                                            std::uint32_t singletons) const {
+  if (unseen > m_CardCount || singletons > MaxSingletons(unseen) ||
+      (unseen - singletons) % 2 != 0) {
+    return 0;
+  }
+
+  return m_Decisions[m_RowOffsets[unseen] + singletons / 2];
+}
+
+std::shared_ptr<const OptimalPlaySolver>
+OptimalPlaySolver::For(std::uint32_t card_count) {
+  static std::mutex mutex;
+  static std::shared_ptr<const OptimalPlaySolver> solver;
+
+  std::lock_guard lock(mutex);
+
+  // Values don't depend on the board size, the largest table serves all
+  if (solver == nullptr || solver->GetCardCount() < card_count) {
+    solver = std::make_shared<const OptimalPlaySolver>(card_count);
+  }
+
+  return solver;
+}
+
+std::uint32_t OptimalPlaySolver::MaxSingletons(std::uint32_t unseen) const {
+  // Singletons are seen cards with an unseen partner
+  return std::min(unseen, m_CardCount - unseen);
+}
+
+/* OptimalPolicy */
+
+void OptimalPolicy::Reset(std::uint32_t board_size, std::uint64_t seed) {
+  PerfectMemoryPolicy::Reset(board_size, seed);
+
+  if (m_Solver == nullptr ||
+      m_Solver->GetCardCount() < board_size * board_size) {
+    m_Solver = OptimalPlaySolver::For(board_size * board_size);
+  }
+
+  m_Decision = 0;
+  m_FirstWasUnseen = false;
+}
+
+std::uint32_t OptimalPolicy::ChooseCard(const MemoryLogic &logic) {
+  if (logic.GetGameStatus() == GameStatus::selectingFirstCard) {
+    m_FirstIndex = kNoCard;
+
+    const auto revealed = logic.GetHasCardBeenRevealed();
+
+    // Known pairs are free
+    for (const auto &[age, index] : m_Pairs) {
+      if (FindPartner(logic, index, m_Memory[index]) != kNoCard &&
+          !revealed[index / m_BoardSize][index % m_BoardSize]) {
+        return index;
+      }
+    }
+
+    // Every remembered card is face down and not part of a known pair now
+    const std::uint32_t remembered =
+        static_cast<std::uint32_t>(m_RememberedCount);
+    const std::uint32_t singletons =
+        remembered - 2 * static_cast<std::uint32_t>(m_Pairs.size());
+
+    m_Decision = m_Solver->GetDecision(
+        logic.GetFaceDownCardsCount() - remembered, singletons);
+
+    if ((m_Decision & OptimalPlaySolver::kSingletonFirst) != 0) {
+      const std::uint32_t singleton = FindSingleton(logic, kNoCard);
+      if (singleton != kNoCard) {
+        return singleton;
+      }
+    }
+
+    return RandomFaceDownCard(logic, &m_Known);
+  }
+
+  // Second card: the partner of the first card if it's known
+  if (m_FirstIndex != kNoCard) {
+    const std::uint32_t partner = FindPartner(logic, m_FirstIndex, m_FirstCard);
+    if (partner != kNoCard) {
+      return partner;
+    }
+  }
+
+  // Don't show the next player another new card if that's better
+  if (m_FirstWasUnseen &&
+      (m_Decision & OptimalPlaySolver::kSingletonSecond) != 0) {
+    const std::uint32_t singleton = FindSingleton(logic, m_FirstIndex);
+    if (singleton != kNoCard) {
+      return singleton;
+    }
+  }
+
+  return RandomFaceDownCard(logic, &m_Known);
+}
+
+void OptimalPolicy::Observe(std::uint32_t index, CardId card) {
+  // Remembered before this call means seen before
+  if (m_FirstIndex == kNoCard) {
+    m_FirstWasUnseen = m_Memory[index] == kUnknownCard;
+  }
+
+  PerfectMemoryPolicy::Observe(index, card);
+}
+
+std::uint32_t OptimalPolicy::FindSingleton(const MemoryLogic &logic,
+                                           std::uint32_t except) const {
+  const auto revealed = logic.GetHasCardBeenRevealed();
+
+  for (std::uint32_t index = m_Oldest; index != kNoCard;
+       index = m_Newer[index]) {
+    const auto &cells = m_Cells[m_Memory[index]];
+
+    if (index != except && (cells[0] == kNoCard || cells[1] == kNoCard) &&
+        !revealed[index / m_BoardSize][index % m_BoardSize]) {
+      return index;
+    }
+  }
+
+  return kNoCard;
+}
+
+} // namespace memory_game
@@ -0,0 +1,93 @@
+#pragma once
+
+// local
+#include "simulation.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace memory_game {
+
+// Expected value optimal play of the memory game when every player remembers
+// every card seen.
+//
+// With perfect memory the position before a turn is fully described by the
+// number of face down cards nobody has seen (unseen) and the number of seen
+// face down cards whose partner is unseen (singletons); known pairs are
+// always taken first. For each such state the solver stores which of the
+// three sensible turns maximizes the expected number of pairs the player
+// wins minus the pairs the others win:
+//
+//   - turn an unseen card, then another unseen one
+//   - turn an unseen card, then a singleton, revealing nothing more
+//   - turn a singleton, then an unseen card
+//
+// Every turn reveals at least one unseen card, so states only lead to states
+// with fewer unseen cards and the table is filled bottom up in one pass. More
+// than two players are treated as one opponent.
+class OptimalPlaySolver {
+public:
+  // Decision bits
+  static constexpr std::uint8_t kSingletonFirst = 1;  // Turn a singleton first
+  static constexpr std::uint8_t kSingletonSecond = 2; // After a new first
+                                                      // card, turn a singleton
+
+  // Solve every state of boards up to card_count cards
+  explicit OptimalPlaySolver(std::uint32_t card_count);
+
+  // Return decision bits for unseen and singletons, 0 for states outside the
+  // table
+  std::uint8_t GetDecision(std::uint32_t unseen,
+                           std::uint32_t singletons) const;
+
+  // Return expected pairs won minus pairs lost by the first player of a
+  // fresh board of card_count cards (the constructor's)
+  double GetExpectedMargin() const { return m_ExpectedMargin; }
+
+  // Return number of cards the solver covers
+  std::uint32_t GetCardCount() const { return m_CardCount; }
+
+  // Return a shared solver covering at least card_count cards. Thread safe,
+  // a table is only built when a larger board than before asks for one.
+  static std::shared_ptr<const OptimalPlaySolver> For(std::uint32_t card_count);
+
+private:
+  // Return largest singleton count of states with unseen cards
+  std::uint32_t MaxSingletons(std::uint32_t unseen) const;
+
+  std::uint32_t m_CardCount;
+
+  // Decision per state: row unseen starts at m_RowOffsets[unseen], then one
+  // entry per singleton count of the same parity as unseen
+  std::vector<std::size_t> m_RowOffsets{};
+  std::vector<std::uint8_t> m_Decisions{};
+
+  double m_ExpectedMargin = 0.0;
+};
+
+// Perfect memory player that plays the expected value optimal turn of
+// OptimalPlaySolver
+class OptimalPolicy : public PerfectMemoryPolicy {
+public:
+  void Reset(std::uint32_t board_size, std::uint64_t seed) override;
+
+  std::uint32_t ChooseCard(const MemoryLogic &logic) override;
+
+  void Observe(std::uint32_t index, CardId card) override;
+
+private:
+  // Return oldest remembered face down card whose partner is unknown, other
+  // than except, or kNoCard
+  std::uint32_t FindSingleton(const MemoryLogic &logic,
+                              std::uint32_t except) const;
+
+  std::shared_ptr<const OptimalPlaySolver> m_Solver{};
+
+  std::uint8_t m_Decision = 0;   // Decision of the current turn
+  bool m_FirstWasUnseen = false; // Whether the turn's first card was new
+};
+
+} // namespace memory_game
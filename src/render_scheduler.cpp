@@ -0,0 +1,129 @@
+// header
+#include "render_scheduler.hpp"
+
+// libs
+// FTXUI includes
+#include <ftxui/component/component_base.hpp>
+#include <ftxui/component/event.hpp>
+#include <ftxui/screen/terminal.hpp>
+
+// std
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace memory_game {
+
+namespace {
+
+// Move average a 1/32 of the way towards sample
+std::chrono::microseconds Average(std::chrono::microseconds average,
+                                  std::chrono::microseconds sample) {
+  return average + (sample - average) / 32;
+}
+
+// Forwards events to the wrapped component and tells the scheduler which of
+// them changed the frame
+class RenderOnChangeBase : public ftxui::ComponentBase {
+public:
+  RenderOnChangeBase(ftxui::Component component, RenderScheduler *scheduler)
+      : m_Scheduler(scheduler) {
+    Add(std::move(component));
+  }
+
+  bool OnEvent(ftxui::Event event) override {
+    m_Scheduler->OnEvent();
+
+    const bool handled = ComponentBase::OnEvent(event);
+
+    if (handled || event.is_mouse() || event == ftxui::Event::Custom) {
+      m_Scheduler->Invalidate();
+    }
+
+    return handled;
+  }
+
+  ftxui::Element Render() override {
+    const ftxui::Dimensions size = ftxui::Terminal::Size();
+
+    return m_Scheduler->Render(size.dimx, size.dimy,
+                               [this] { return ComponentBase::Render(); });
+  }
+
+private:
+  RenderScheduler *m_Scheduler;
+};
+
+} // namespace
+
+/* RenderScheduler */
+
+void RenderScheduler::WaitForFrame() const {
+  std::this_thread::sleep_until(m_LastFrame + m_Interval);
+}
+
+void RenderScheduler::OnEvent() {
+  if (!m_InFrame) {
+    m_InFrame = true;
+    m_FrameStart = Clock::now();
+  }
+
+  m_Stats.events++;
+}
+
+ftxui::Element
+RenderScheduler::Render(std::int32_t width, std::int32_t height,
+                        const std::function<ftxui::Element()> &build) {
+  if (!m_InFrame) {
+    m_InFrame = true;
+    m_FrameStart = Clock::now();
+  }
+
+  // Everything is laid out anew on another screen size
+  if (width != m_Width || height != m_Height) {
+    m_Width = width;
+    m_Height = height;
+    m_Dirty = true;
+  }
+
+  if (!m_Dirty && m_Frame != nullptr) {
+    m_Stats.skipped++;
+    return m_Frame;
+  }
+
+  const Clock::time_point start = Clock::now();
+  m_Frame = build();
+  m_Dirty = false;
+
+  m_Stats.frames++;
+  m_Stats.last_build = std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - start);
+  m_Stats.average_build =
+      Average(m_Stats.average_build, m_Stats.last_build);
+
+  return m_Frame;
+}
+
+void RenderScheduler::EndFrame() {
+  const Clock::time_point now = Clock::now();
+
+  if (m_InFrame) {
+    m_Stats.last_frame =
+        std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                              m_FrameStart);
+    m_Stats.average_frame =
+        Average(m_Stats.average_frame, m_Stats.last_frame);
+    m_Stats.max_frame = std::max(m_Stats.max_frame, m_Stats.last_frame);
+
+    m_LastFrame = m_FrameStart;
+  }
+
+  m_InFrame = false;
+}
+
+ftxui::Component RenderOnChange(ftxui::Component component,
+                                RenderScheduler *scheduler) {
+  return ftxui::Make<RenderOnChangeBase>(std::move(component), scheduler);
+}
+
+} // namespace memory_game
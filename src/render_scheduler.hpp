@@ -0,0 +1,89 @@
+#pragma once
+
+// libs
+// FTXUI includes
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace memory_game {
+
+// Timing of the frames drawn so far
+struct FrameStats {
+  std::uint64_t frames = 0;  // Frames whose element tree was rebuilt
+  std::uint64_t skipped = 0; // Frames that reused the previous tree
+  std::uint64_t events = 0;  // Events handled, several per frame in bursts
+
+  // Event handling, build, layout and terminal output of the last frame
+  std::chrono::microseconds last_frame{};
+  // Building the element tree of the last rebuilt frame
+  std::chrono::microseconds last_build{};
+
+  // Moving averages over about the last 32 frames
+  std::chrono::microseconds average_frame{};
+  std::chrono::microseconds average_build{};
+
+  std::chrono::microseconds max_frame{}; // Slowest frame so far
+};
+
+// Paces the UI loop.
+//
+// Events that arrive while a frame is being drawn or during the rest of the
+// frame interval are handled together before a single frame is drawn, so a
+// burst of mouse motion costs one frame per interval instead of one per
+// event. The element tree is only rebuilt when an event changed something
+// the frame shows, otherwise the previous tree is drawn again.
+class RenderScheduler {
+public:
+  explicit RenderScheduler(
+      std::chrono::microseconds interval = std::chrono::microseconds(16667))
+      : m_Interval(interval) {}
+
+  // Note that the next frame must be rebuilt
+  void Invalidate() { m_Dirty = true; }
+
+  // Sleep until the next frame may start
+  void WaitForFrame() const;
+
+  // Record an event handled for the coming frame
+  void OnEvent();
+
+  // Return the frame element of a width x height screen, calling build only
+  // if something changed since the last frame
+  ftxui::Element Render(std::int32_t width, std::int32_t height,
+                        const std::function<ftxui::Element()> &build);
+
+  // Record the end of the frame drawn last
+  void EndFrame();
+
+  // Return timing of the frames drawn so far
+  const FrameStats &GetStats() const { return m_Stats; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::chrono::microseconds m_Interval;
+
+  bool m_Dirty = true;
+  ftxui::Element m_Frame{}; // Element tree of the last rebuilt frame
+  std::int32_t m_Width = -1;
+  std::int32_t m_Height = -1;
+
+  bool m_InFrame = false;           // Whether the coming frame has started
+  Clock::time_point m_FrameStart{}; // First event or render of the frame
+  Clock::time_point m_LastFrame{};  // Start of the previous frame
+
+  FrameStats m_Stats{};
+};
+
+// Wrap component so its events and frames go through scheduler. Events it
+// handles, mouse events (hover and the background follow the mouse) and
+// posted results (Event::Custom) mark the frame for rebuilding.
+ftxui::Component RenderOnChange(ftxui::Component component,
+                                RenderScheduler *scheduler);
+
+} // namespace memory_game
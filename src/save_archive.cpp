@@ -0,0 +1,688 @@
+// header
+#include "save_archive.hpp"
+
+// local
+#include "common.hpp"
+#include "lz_codec.hpp"
+#include "save_format.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace memory_game {
+
+namespace {
+
+// Largest single read or write, Windows takes 32 bit sizes
+constexpr std::size_t kMaxIoChunk = std::size_t{1} << 30;
+
+// Saves read into memory at once while importing
+constexpr std::size_t kImportBatchSize = 1024;
+
+// Record and index entry bytes covered by their CRCs
+constexpr std::size_t kRecordCrcSize =
+    offsetof(ArchiveRecordHeader, header_crc);
+constexpr std::size_t kEntryCrcSize = offsetof(ArchiveEntry, entry_crc);
+
+constexpr std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Return bytes a record with data_size bytes of data takes in the pack
+std::uint64_t RecordSize(std::uint32_t data_size) {
+  return sizeof(ArchiveRecordHeader) + AlignUp(data_size, 8);
+}
+
+template <typename T> std::uint32_t CrcOf(const T &value, std::size_t size) {
+  return Crc32(std::span<const std::byte>(
+      reinterpret_cast<const std::byte *>(&value), size));
+}
+
+// Return whether header is a record header with a valid CRC
+bool IsValidRecord(const ArchiveRecordHeader &header) {
+  return std::memcmp(header.magic, kArchiveRecordMagic,
+                     sizeof(kArchiveRecordMagic)) == 0 &&
+         header.header_crc == CrcOf(header, kRecordCrcSize);
+}
+
+} // namespace
+
+/* Platform file access */
+
+#ifdef _WIN32
+
+SaveArchive::SaveArchive(const std::filesystem::path &filename)
+    : m_IndexFile(filename.string() + ".idx") {
+  std::error_code error{};
+  if (filename.has_parent_path()) {
+    std::filesystem::create_directories(filename.parent_path(), error);
+  }
+
+  m_File = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                       FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                       OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_File == INVALID_HANDLE_VALUE) {
+    m_File = nullptr;
+    return;
+  }
+
+  Open();
+}
+
+SaveArchive::~SaveArchive() {
+  if (m_File != nullptr) {
+    CloseHandle(m_File);
+  }
+}
+
+bool SaveArchive::WriteAt(const void *data, std::size_t size,
+                          std::uint64_t offset) {
+  const auto *bytes = static_cast<const std::byte *>(data);
+
+  while (size > 0) {
+    OVERLAPPED position{};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    const auto chunk =
+        static_cast<DWORD>(std::min<std::size_t>(size, kMaxIoChunk));
+    DWORD written = 0;
+    if (!WriteFile(m_File, bytes, chunk, &written, &position) ||
+        written != chunk) {
+      return false;
+    }
+
+    bytes += chunk;
+    offset += chunk;
+    size -= chunk;
+  }
+
+  return true;
+}
+
+bool SaveArchive::ReadAt(void *data, std::size_t size,
+                         std::uint64_t offset) const {
+  auto *bytes = static_cast<std::byte *>(data);
+
+  while (size > 0) {
+    OVERLAPPED position{};
+    position.Offset = static_cast<DWORD>(offset);
+    position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+    const auto chunk =
+        static_cast<DWORD>(std::min<std::size_t>(size, kMaxIoChunk));
+    DWORD read = 0;
+    if (!ReadFile(m_File, bytes, chunk, &read, &position) || read != chunk) {
+      return false;
+    }
+
+    bytes += chunk;
+    offset += chunk;
+    size -= chunk;
+  }
+
+  return true;
+}
+
+bool SaveArchive::Sync() { return FlushFileBuffers(m_File); }
+
+bool SaveArchive::LockPack(bool exclusive, bool wait) {
+  // Byte range locks block I/O on the range for other processes, so lock a
+  // byte far past any data
+  OVERLAPPED position{};
+  position.Offset = 0xFFFFFFFF;
+  position.OffsetHigh = 0x7FFFFFFF;
+
+  const DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) |
+                      (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+  return LockFileEx(m_File, flags, 0, 1, 0, &position);
+}
+
+void SaveArchive::UnlockPack() {
+  OVERLAPPED position{};
+  position.Offset = 0xFFFFFFFF;
+  position.OffsetHigh = 0x7FFFFFFF;
+
+  UnlockFileEx(m_File, 0, 1, 0, &position);
+}
+
+std::uint64_t SaveArchive::GetFileSize() const {
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(m_File, &size)) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(size.QuadPart);
+}
+
+#else
+
+SaveArchive::SaveArchive(const std::filesystem::path &filename)
+    : m_IndexFile(filename.string() + ".idx") {
+  std::error_code error{};
+  if (filename.has_parent_path()) {
+    std::filesystem::create_directories(filename.parent_path(), error);
+  }
+
+  m_Fd = open(filename.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (m_Fd < 0) {
+    return;
+  }
+
+  Open();
+}
+
+SaveArchive::~SaveArchive() {
+  if (m_Fd >= 0) {
+    close(m_Fd);
+  }
+}
+
+bool SaveArchive::WriteAt(const void *data, std::size_t size,
+                          std::uint64_t offset) {
+  const auto *bytes = static_cast<const std::byte *>(data);
+
+  for (std::size_t written = 0; written < size;) {
+    const ssize_t result = pwrite(m_Fd, bytes + written, size - written,
+                                  static_cast<off_t>(offset + written));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+
+    written += static_cast<std::size_t>(result);
+  }
+
+  return true;
+}
+
+bool SaveArchive::ReadAt(void *data, std::size_t size,
+                         std::uint64_t offset) const {
+  auto *bytes = static_cast<std::byte *>(data);
+
+  for (std::size_t read = 0; read < size;) {
+    const ssize_t result = pread(m_Fd, bytes + read, size - read,
+                                 static_cast<off_t>(offset + read));
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+
+    read += static_cast<std::size_t>(result);
+  }
+
+  return true;
+}
+
+bool SaveArchive::Sync() {
+#ifdef __linux__
+  return fdatasync(m_Fd) == 0;
+#else
+  return fsync(m_Fd) == 0;
+#endif
+}
+
+bool SaveArchive::LockPack(bool exclusive, bool wait) {
+  const int operation = (exclusive ? LOCK_EX : LOCK_SH) | (wait ? 0 : LOCK_NB);
+
+  for (;;) {
+    if (flock(m_Fd, operation) == 0) {
+      return true;
+    }
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+void SaveArchive::UnlockPack() { flock(m_Fd, LOCK_UN); }
+
+std::uint64_t SaveArchive::GetFileSize() const {
+  struct stat info {};
+  if (fstat(m_Fd, &info) != 0) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(info.st_size);
+}
+
+#endif
+
+/* SaveArchive */
+
+void SaveArchive::Open() {
+  ArchiveHeader header{};
+
+  // A new pack, or one whose creation was cut short before any record
+  if (GetFileSize() < sizeof(header)) {
+    std::memcpy(header.magic, kArchiveMagic, sizeof(kArchiveMagic));
+    header.version = kArchiveVersion;
+
+    if (!WriteAt(&header, sizeof(header), 0) || !Sync()) {
+      return;
+    }
+  } else if (!ReadAt(&header, sizeof(header), 0) ||
+             std::memcmp(header.magic, kArchiveMagic, sizeof(kArchiveMagic)) !=
+                 0 ||
+             header.version != kArchiveVersion) {
+    // Not ours, leave it alone
+    return;
+  }
+
+  // Another process may be appending or repairing the index
+  if (!LockPack(true, true)) {
+    return;
+  }
+
+  m_End = sizeof(header);
+  ReadIndexFile();
+
+  // Records the index missed, e.g. the process died before indexing them
+  const std::vector<ArchiveEntry> missed = ScanRecords();
+  m_Entries.insert(m_Entries.end(), missed.begin(), missed.end());
+  AppendToIndexFile(missed);
+
+  UnlockPack();
+
+  m_IsOpen = true;
+}
+
+bool SaveArchive::Append(std::span<const std::byte> image,
+                         std::int64_t timestamp) {
+  const ArchiveSave save{image, timestamp};
+  return AppendBatch(std::span(&save, 1));
+}
+
+bool SaveArchive::AppendBatch(std::span<const ArchiveSave> saves,
+                              WorkStealingPool *pool) {
+  if (!m_IsOpen) {
+    return false;
+  }
+
+  if (saves.empty()) {
+    return true;
+  }
+
+  for (const ArchiveSave &save : saves) {
+    if (save.image.size() > UINT32_MAX) {
+      return false;
+    }
+  }
+
+  // Compress each image, keeping it as is if that doesn't make it smaller
+  std::vector<std::vector<std::byte>> compressed(saves.size());
+
+  const auto compress = [&](std::size_t begin, std::size_t end,
+                            std::uint32_t) {
+    for (std::size_t i = begin; i < end; i++) {
+      LzCompress(saves[i].image, compressed[i]);
+
+      if (compressed[i].size() >= saves[i].image.size()) {
+        compressed[i] = {};
+      }
+    }
+  };
+
+  if (pool != nullptr) {
+    pool->Run(saves.size(), 1, compress);
+  } else {
+    compress(0, saves.size(), 0);
+  }
+
+  std::lock_guard<std::mutex> write_lock(m_WriteMutex);
+
+  if (!LockPack(true, true)) {
+    return false;
+  }
+
+  const bool appended = AppendLocked(saves, compressed);
+  UnlockPack();
+
+  return appended;
+}
+
+bool SaveArchive::AppendLocked(
+    std::span<const ArchiveSave> saves,
+    const std::vector<std::vector<std::byte>> &compressed) {
+  // Pick up records other processes appended, their writers indexed them
+  const std::vector<ArchiveEntry> added = ScanRecords();
+  if (!added.empty()) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.insert(m_Entries.end(), added.begin(), added.end());
+  }
+
+  // Lay the records out back to back
+  std::vector<std::byte> records{};
+  std::vector<ArchiveEntry> entries(saves.size());
+
+  for (std::size_t i = 0; i < saves.size(); i++) {
+    const bool is_compressed = !compressed[i].empty();
+    const std::span<const std::byte> data =
+        is_compressed ? std::span<const std::byte>(compressed[i])
+                      : saves[i].image;
+
+    ArchiveRecordHeader header{};
+    std::memcpy(header.magic, kArchiveRecordMagic,
+                sizeof(kArchiveRecordMagic));
+    header.flags = is_compressed ? kArchiveCompressed : 0;
+    header.timestamp = saves[i].timestamp;
+    header.image_size = static_cast<std::uint32_t>(saves[i].image.size());
+    header.data_size = static_cast<std::uint32_t>(data.size());
+    header.image_crc = Crc32(saves[i].image);
+    header.header_crc = CrcOf(header, kRecordCrcSize);
+
+    ArchiveEntry &entry = entries[i];
+    entry.id = m_End + records.size();
+    entry.timestamp = header.timestamp;
+    entry.image_size = header.image_size;
+    entry.data_size = header.data_size;
+    entry.flags = header.flags;
+    entry.entry_crc = CrcOf(entry, kEntryCrcSize);
+
+    const auto *header_bytes = reinterpret_cast<const std::byte *>(&header);
+    records.insert(records.end(), header_bytes, header_bytes + sizeof(header));
+    records.insert(records.end(), data.begin(), data.end());
+    records.resize(entry.id - m_End + RecordSize(header.data_size));
+  }
+
+  // A failed write leaves garbage past m_End that the next append, of any
+  // process, overwrites
+  if (!WriteAt(records.data(), records.size(), m_End) || !Sync()) {
+    return false;
+  }
+
+  m_End += records.size();
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.insert(m_Entries.end(), entries.begin(), entries.end());
+  }
+
+  AppendToIndexFile(entries);
+
+  return true;
+}
+
+bool SaveArchive::Load(std::uint64_t id, std::vector<std::byte> &image) const {
+  ArchiveEntry entry{};
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const auto it = std::lower_bound(
+        m_Entries.begin(), m_Entries.end(), id,
+        [](const ArchiveEntry &entry, std::uint64_t id) {
+          return entry.id < id;
+        });
+
+    if (it == m_Entries.end() || it->id != id) {
+      return false;
+    }
+
+    entry = *it;
+  }
+
+  // Records are never changed once written, no lock needed to read them
+  ArchiveRecordHeader header{};
+  if (!ReadAt(&header, sizeof(header), entry.id) || !IsValidRecord(header) ||
+      header.image_size != entry.image_size ||
+      header.data_size != entry.data_size) {
+    return false;
+  }
+
+  std::vector<std::byte> data(header.data_size);
+  if (!ReadAt(data.data(), data.size(), entry.id + sizeof(header))) {
+    return false;
+  }
+
+  if ((header.flags & kArchiveCompressed) != 0) {
+    std::vector<std::byte> decompressed(header.image_size);
+    if (!LzDecompress(data, decompressed)) {
+      return false;
+    }
+    data = std::move(decompressed);
+  } else if (data.size() != header.image_size) {
+    return false;
+  }
+
+  if (Crc32(data) != header.image_crc) {
+    return false;
+  }
+
+  image = std::move(data);
+  return true;
+}
+
+std::size_t SaveArchive::GetCount() const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.size();
+}
+
+std::vector<ArchiveEntry> SaveArchive::List(std::size_t first,
+                                            std::size_t count) const {
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  first = std::min(first, m_Entries.size());
+  count = std::min(count, m_Entries.size() - first);
+
+  return {m_Entries.begin() + first, m_Entries.begin() + first + count};
+}
+
+bool SaveArchive::Refresh() {
+  if (!m_IsOpen) {
+    return false;
+  }
+
+  // Picked up by the append itself while this process appends
+  std::unique_lock<std::mutex> write_lock(m_WriteMutex, std::try_to_lock);
+  if (!write_lock.owns_lock()) {
+    return false;
+  }
+
+  if (GetFileSize() <= m_End) {
+    return false;
+  }
+
+  // Skip records another process is still writing, the next call gets them.
+  // The writing process indexes them.
+  if (!LockPack(false, false)) {
+    return false;
+  }
+
+  const std::vector<ArchiveEntry> added = ScanRecords();
+  UnlockPack();
+
+  if (added.empty()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Entries.insert(m_Entries.end(), added.begin(), added.end());
+
+  return true;
+}
+
+std::size_t SaveArchive::Import(const std::filesystem::path &directory,
+                                bool remove_files, WorkStealingPool *pool) {
+  struct SaveFile {
+    std::int64_t timestamp;
+    std::uint32_t sequence;
+    std::filesystem::path path;
+  };
+
+  std::vector<SaveFile> files{};
+  for (const auto &path : get_file_list(directory)) {
+    SaveFile file{0, 0, path};
+    if (parse_timestamp_filename(path, file.timestamp, file.sequence)) {
+      files.push_back(std::move(file));
+    }
+  }
+
+  std::sort(files.begin(), files.end(),
+            [](const SaveFile &a, const SaveFile &b) {
+              return std::tie(a.timestamp, a.sequence) <
+                     std::tie(b.timestamp, b.sequence);
+            });
+
+  std::size_t imported = 0;
+
+  for (std::size_t first = 0; first < files.size();
+       first += kImportBatchSize) {
+    const std::size_t last = std::min(first + kImportBatchSize, files.size());
+
+    std::vector<std::vector<std::byte>> images(last - first);
+    std::vector<ArchiveSave> saves{};
+    std::vector<const SaveFile *> read{};
+
+    for (std::size_t i = first; i < last; i++) {
+      std::vector<std::byte> &image = images[i - first];
+      if (read_file(files[i].path, image)) {
+        saves.push_back({image, files[i].timestamp});
+        read.push_back(&files[i]);
+      }
+    }
+
+    if (!AppendBatch(saves, pool)) {
+      break;
+    }
+
+    imported += saves.size();
+
+    if (remove_files) {
+      for (const SaveFile *file : read) {
+        std::error_code error{};
+        std::filesystem::remove(file->path, error);
+      }
+    }
+  }
+
+  return imported;
+}
+
+std::size_t SaveArchive::Export(const std::filesystem::path &directory) const {
+  std::error_code error{};
+  std::filesystem::create_directories(directory, error);
+
+  std::size_t exported = 0;
+  std::vector<std::byte> image{};
+
+  for (const ArchiveEntry &entry : List(0, GetCount())) {
+    if (Load(entry.id, image) &&
+        write_file_atomically(
+            get_timestamp_filename(directory,
+                                   static_cast<std::time_t>(entry.timestamp)),
+            image)) {
+      exported++;
+    }
+  }
+
+  return exported;
+}
+
+void SaveArchive::AppendToIndexFile(std::span<const ArchiveEntry> entries) {
+  if (entries.empty()) {
+    return;
+  }
+
+  // Not synced, the pack is the source of truth and a lost entry is found
+  // again by the next scan
+  std::ofstream file(m_IndexFile, std::ios::binary | std::ios::app);
+  file.write(reinterpret_cast<const char *>(entries.data()),
+             entries.size_bytes());
+}
+
+void SaveArchive::ReadIndexFile() {
+  std::vector<std::byte> data{};
+  if (!read_file(m_IndexFile, data)) {
+    return;
+  }
+
+  const std::uint64_t pack_size = GetFileSize();
+  const std::size_t count = data.size() / sizeof(ArchiveEntry);
+
+  m_Entries.resize(count);
+  std::memcpy(m_Entries.data(), data.data(), count * sizeof(ArchiveEntry));
+
+  // Every entry must start where the previous record ended
+  std::size_t valid = 0;
+  for (; valid < count; valid++) {
+    const ArchiveEntry &entry = m_Entries[valid];
+    const std::uint64_t end = entry.id + RecordSize(entry.data_size);
+
+    if (entry.entry_crc != CrcOf(entry, kEntryCrcSize) || entry.id != m_End ||
+        end > pack_size) {
+      break;
+    }
+
+    m_End = end;
+  }
+
+  m_Entries.resize(valid);
+
+  // Drop the torn or stale tail, so new entries aren't appended after it
+  if (valid * sizeof(ArchiveEntry) != data.size()) {
+    write_file_atomically(
+        m_IndexFile,
+        std::span<const std::byte>(
+            reinterpret_cast<const std::byte *>(m_Entries.data()),
+            valid * sizeof(ArchiveEntry)));
+  }
+}
+
+std::vector<ArchiveEntry> SaveArchive::ScanRecords() {
+  std::vector<ArchiveEntry> entries{};
+  const std::uint64_t pack_size = GetFileSize();
+
+  while (m_End + sizeof(ArchiveRecordHeader) <= pack_size) {
+    ArchiveRecordHeader header{};
+    if (!ReadAt(&header, sizeof(header), m_End) || !IsValidRecord(header)) {
+      break;
+    }
+
+    // Torn record at the end
+    const std::uint64_t end = m_End + RecordSize(header.data_size);
+    if (end > pack_size) {
+      break;
+    }
+
+    ArchiveEntry entry{};
+    entry.id = m_End;
+    entry.timestamp = header.timestamp;
+    entry.image_size = header.image_size;
+    entry.data_size = header.data_size;
+    entry.flags = header.flags;
+    entry.entry_crc = CrcOf(entry, kEntryCrcSize);
+    entries.push_back(entry);
+
+    m_End = end;
+  }
+
+  return entries;
+}
+
+} // namespace memory_game
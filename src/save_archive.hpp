@@ -0,0 +1,214 @@
+/*
+ *
+ * Save archive, version 1.
+ *
+ * Packs any number of saves into one append-only pack file instead of a
+ * file per save. Every save is a record compressed with the LZ codec (see
+ * lz_codec.hpp), or stored as is if that's not smaller. A save's id is the
+ * offset of its record, so ids are unique and increase with every save,
+ * also within the same second.
+ *
+ * Pack file layout, all integers little endian:
+ *   offset  size  field
+ *        0     8  magic "MEMPACK\0"
+ *        8     4  format version (1)
+ *       12     4  reserved (0)
+ *       16        records
+ *
+ * Record, data zero padded to a multiple of 8 bytes:
+ *   offset  size  field
+ *        0     4  magic "MREC"
+ *        4     4  flags, bit 0: data is compressed
+ *        8     8  unix time of the save
+ *       16     4  size of the save image in bytes
+ *       20     4  size of the data in bytes
+ *       24     4  CRC-32 of the save image
+ *       28     4  CRC-32 of record bytes 0..27
+ *       32        data
+ *
+ * Next to the pack, "<pack>.idx" lists every record as a fixed size entry
+ * with its own CRC, appended after the record is on disk. Opening reads the
+ * index and scans only records the index misses (e.g. after a crash), so
+ * neither opening nor anything afterwards walks the pack. Entries are kept
+ * sorted by id in memory: finding, listing a range and loading a save take
+ * O(log n) whatever the size of the archive.
+ *
+ * Several processes may share a pack. Appending and repairing the index take
+ * an exclusive lock on the pack file (flock, LockFileEx) and first pick up
+ * the records other processes added, so every record goes to the real end of
+ * the pack. Refresh picks up new saves under a shared lock.
+ *
+ */
+
+#pragma once
+
+// local
+#include "work_stealing_pool.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace memory_game {
+
+// Magic at the start of every pack file and every record
+inline constexpr char kArchiveMagic[8] = {'M', 'E', 'M', 'P',
+                                          'A', 'C', 'K', '\0'};
+inline constexpr char kArchiveRecordMagic[4] = {'M', 'R', 'E', 'C'};
+
+// Current archive format version
+inline constexpr std::uint32_t kArchiveVersion = 1;
+
+// Record flag: data is LZ compressed
+inline constexpr std::uint32_t kArchiveCompressed = 1;
+
+// Pack file header, see the layout above
+struct ArchiveHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16, "Archive header must be 16 bytes");
+
+// Record header, see the layout above
+struct ArchiveRecordHeader {
+  char magic[4];
+  std::uint32_t flags;
+  std::int64_t timestamp;
+  std::uint32_t image_size;
+  std::uint32_t data_size;
+  std::uint32_t image_crc;
+  std::uint32_t header_crc;
+};
+
+static_assert(sizeof(ArchiveRecordHeader) == 32,
+              "Archive record header must be 32 bytes");
+
+// One save of an archive, also the layout of an index file entry
+struct ArchiveEntry {
+  std::uint64_t id;        // Offset of the record in the pack
+  std::int64_t timestamp;  // Unix time of the save
+  std::uint32_t image_size;
+  std::uint32_t data_size;
+  std::uint32_t flags;
+  std::uint32_t entry_crc; // CRC-32 of entry bytes 0..27, in the index file
+};
+
+static_assert(sizeof(ArchiveEntry) == 32, "Archive entry must be 32 bytes");
+
+// Save to add with AppendBatch
+struct ArchiveSave {
+  std::span<const std::byte> image;
+  std::int64_t timestamp;
+};
+
+// Pack of saves. Safe to use from several threads at once: appends are
+// serialized, loads and listings don't wait for the disk writes of appends.
+class SaveArchive {
+public:
+  // Open pack file, creating it and its directory if needed. IsOpen() tells
+  // whether it worked.
+  explicit SaveArchive(const std::filesystem::path &filename);
+
+  SaveArchive(const SaveArchive &) = delete;
+  SaveArchive &operator=(const SaveArchive &) = delete;
+
+  ~SaveArchive();
+
+  // Whether the pack could be opened
+  bool IsOpen() const { return m_IsOpen; }
+
+  // Append save image made at timestamp, durable once this returns. Returns
+  // false if it couldn't be written.
+  bool Append(std::span<const std::byte> image, std::int64_t timestamp);
+
+  // Append saves, in order, with a single write and sync. Images are
+  // compressed in parallel on pool if given. Returns false if they couldn't
+  // be written, then none of them is added.
+  bool AppendBatch(std::span<const ArchiveSave> saves,
+                   WorkStealingPool *pool = nullptr);
+
+  // Read save id into image. Returns false if there is no such save or its
+  // record is corrupted.
+  bool Load(std::uint64_t id, std::vector<std::byte> &image) const;
+
+  // Return number of saves
+  std::size_t GetCount() const;
+
+  // Return saves first..first + count - 1 in the order they were added,
+  // fewer at the end
+  std::vector<ArchiveEntry> List(std::size_t first, std::size_t count) const;
+
+  // Pick up saves appended by another process. Returns true if there are
+  // new ones. Cheap enough to call on every UI event, returns right away
+  // while this process is appending.
+  bool Refresh();
+
+  // Append every save file of directory ("<unix time>.dat" or
+  // "<unix time>-<n>.dat"), oldest first, as one batch. If remove_files is
+  // true the files are deleted once the batch is on disk. Returns number of
+  // saves imported.
+  std::size_t Import(const std::filesystem::path &directory, bool remove_files,
+                     WorkStealingPool *pool = nullptr);
+
+  // Write every save to directory as a save file named after its time.
+  // Returns number of saves exported.
+  std::size_t Export(const std::filesystem::path &directory) const;
+
+private:
+  // Check or write the pack header and load the index
+  void Open();
+
+  // Append index entries to the index file
+  void AppendToIndexFile(std::span<const ArchiveEntry> entries);
+
+  // Read the index file into m_Entries. Stops at the first entry that
+  // doesn't follow the previous record or lies past the pack's end.
+  void ReadIndexFile();
+
+  // Return records from m_End to the end of the pack and move m_End past
+  // them
+  std::vector<ArchiveEntry> ScanRecords();
+
+  // Append records for saves, with their compressed data if not empty, at
+  // the end of the pack. Caller holds m_WriteMutex and the pack lock.
+  bool AppendLocked(std::span<const ArchiveSave> saves,
+                    const std::vector<std::vector<std::byte>> &compressed);
+
+  // Lock the pack against other processes, exclusive or shared. Without
+  // wait it fails right away if another process holds the lock. Returns
+  // false on failure.
+  bool LockPack(bool exclusive, bool wait);
+  void UnlockPack();
+
+  // Platform file access, returns false on failure
+  bool WriteAt(const void *data, std::size_t size, std::uint64_t offset);
+  bool ReadAt(void *data, std::size_t size, std::uint64_t offset) const;
+  bool Sync();
+  std::uint64_t GetFileSize() const;
+
+  bool m_IsOpen = false;
+
+  std::filesystem::path m_IndexFile;
+
+#ifdef _WIN32
+  void *m_File = nullptr; // Pack file handle
+#else
+  int m_Fd = -1; // Pack file descriptor
+#endif
+
+  // Held while appending or scanning, together with the pack lock
+  std::mutex m_WriteMutex;
+  std::uint64_t m_End = 0; // End of the last known record
+
+  // Guards m_Entries, never held during disk I/O
+  mutable std::mutex m_Mutex;
+  std::vector<ArchiveEntry> m_Entries{}; // Sorted by id
+};
+
+} // namespace memory_game
@@ -0,0 +1,270 @@
+// header
+#include "save_format.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace memory_game {
+
+namespace {
+
+// Round size up to a multiple of 8 bytes
+constexpr std::size_t Align8(std::size_t size) { return (size + 7) / 8 * 8; }
+
+// Lookup table for the reflected CRC-32 polynomial
+constexpr std::array<std::uint32_t, 256> MakeCrc32Table() {
+  std::array<std::uint32_t, 256> table{};
+
+  for (std::uint32_t i = 0; i < 256; i++) {
+    std::uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    table[i] = crc;
+  }
+
+  return table;
+}
+
+constexpr std::array<std::uint32_t, 256> kCrc32Table = MakeCrc32Table();
+
+// Header bytes covered by header_crc
+constexpr std::size_t kHeaderCrcSize = offsetof(SaveHeader, header_crc);
+
+} // namespace
+
+SaveLayout SaveLayout::For(std::uint32_t board_size,
+                           std::uint32_t player_count,
+                           std::uint32_t card_width) {
+  const std::size_t cards = static_cast<std::size_t>(board_size) * board_size;
+
+  SaveLayout layout{};
+  layout.mask_words = (cards + 63) / 64;
+  layout.card_width = card_width;
+  layout.counts_offset = sizeof(SaveHeader);
+  layout.board_offset =
+      layout.counts_offset + Align8(player_count * sizeof(std::uint32_t));
+  layout.revealed_offset = layout.board_offset + Align8(cards * card_width);
+  layout.matched_offset =
+      layout.revealed_offset + layout.mask_words * sizeof(std::uint64_t);
+  layout.file_size =
+      layout.matched_offset + layout.mask_words * sizeof(std::uint64_t);
+
+  return layout;
+}
+
+std::optional<SaveView> SaveView::Parse(std::span<const std::byte> image,
+                                        std::string &error) {
+  if (image.size() < sizeof(SaveHeader) || !IsSaveImage(image)) {
+    error = "Not a save file";
+    return std::nullopt;
+  }
+
+  // Sections are read through pointer casts
+  if (reinterpret_cast<std::uintptr_t>(image.data()) % alignof(std::uint64_t) !=
+      0) {
+    error = "Save image is not 8 byte aligned";
+    return std::nullopt;
+  }
+
+  const auto &header = *reinterpret_cast<const SaveHeader *>(image.data());
+
+  if (header.version < 1 || header.version > kSaveVersion ||
+      header.header_size != sizeof(SaveHeader)) {
+    error = "Unsupported save version " + std::to_string(header.version);
+    return std::nullopt;
+  }
+
+  if (Crc32(image.first(kHeaderCrcSize)) != header.header_crc) {
+    error = "Corrupted save header";
+    return std::nullopt;
+  }
+
+  if (header.board_size == 0 || header.board_size > kMaxSaveBoardSize ||
+      header.player_count == 0 || header.player_count > kMaxSavePlayerCount ||
+      header.board_size % 2 != 0 || header.game_status > 3 ||
+      header.player_index >= header.player_count ||
+      header.previous_x >= header.board_size ||
+      header.previous_y >= header.board_size || header.turn_number == 0) {
+    error = "Invalid save header values";
+    return std::nullopt;
+  }
+
+  // Version 1 stored one character per card
+  const std::uint32_t card_width =
+      header.version == 1 ? 1 : header.card_width;
+  const std::uint64_t pair_count =
+      static_cast<std::uint64_t>(header.board_size) * header.board_size / 2;
+
+  if ((card_width != 1 && card_width != 2 && card_width != 4) ||
+      card_width < GetCardWidth(pair_count) ||
+      (header.version == 1 && header.card_width != 0)) {
+    error = "Invalid save card width";
+    return std::nullopt;
+  }
+
+  const SaveLayout layout =
+      SaveLayout::For(header.board_size, header.player_count, card_width);
+
+  if (header.body_size != layout.file_size - sizeof(SaveHeader) ||
+      image.size() < layout.file_size) {
+    error = "Truncated save file";
+    return std::nullopt;
+  }
+
+  if (Crc32(image.subspan(sizeof(SaveHeader), header.body_size)) !=
+      header.body_crc) {
+    error = "Corrupted save body";
+    return std::nullopt;
+  }
+
+  // Every pair must be on the board exactly twice, the game indexes per pair
+  // tables by card id
+  const std::byte *board = image.data() + layout.board_offset;
+  const std::size_t count = pair_count * 2;
+
+  const auto is_complete_deal = [&](auto card_at) {
+    DealChecker deal(pair_count, header.version == 1);
+    for (std::size_t i = 0; i < count; i++) {
+      if (!deal.Add(card_at(i))) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  bool valid = false;
+  switch (card_width) {
+  case 1:
+    valid = is_complete_deal([&](std::size_t i) -> CardId {
+      const auto id = static_cast<std::uint8_t>(board[i]);
+      return header.version == 1 ? static_cast<std::uint8_t>(id - 'A') : id;
+    });
+    break;
+
+  case 2:
+    valid = is_complete_deal([&](std::size_t i) -> CardId {
+      return reinterpret_cast<const std::uint16_t *>(board)[i];
+    });
+    break;
+
+  default:
+    valid = is_complete_deal([&](std::size_t i) -> CardId {
+      return reinterpret_cast<const CardId *>(board)[i];
+    });
+    break;
+  }
+
+  if (!valid) {
+    error = "Invalid save board";
+    return std::nullopt;
+  }
+
+  return SaveView(image.data(), layout);
+}
+
+void SaveView::CopyBoard(CardId *cards) const {
+  const std::size_t count =
+      static_cast<std::size_t>(m_Header->board_size) * m_Header->board_size;
+  const std::byte *board = m_Image + m_Layout.board_offset;
+
+  if (m_Header->version == 1) {
+    // Characters wrapped around past 'A' + 255, so did the pairs
+    for (std::size_t i = 0; i < count; i++) {
+      cards[i] = static_cast<std::uint8_t>(static_cast<std::uint8_t>(board[i]) -
+                                           static_cast<std::uint8_t>('A'));
+    }
+    return;
+  }
+
+  switch (m_Layout.card_width) {
+  case 1:
+    for (std::size_t i = 0; i < count; i++) {
+      cards[i] = static_cast<std::uint8_t>(board[i]);
+    }
+    break;
+
+  case 2: {
+    const auto *ids = reinterpret_cast<const std::uint16_t *>(board);
+    std::copy(ids, ids + count, cards);
+    break;
+  }
+
+  default:
+    std::memcpy(cards, board, count * sizeof(CardId));
+    break;
+  }
+}
+
+void StoreBoard(std::span<std::byte> image, const SaveLayout &layout,
+                const CardId *cards, std::size_t count) {
+  std::byte *board = image.data() + layout.board_offset;
+
+  switch (layout.card_width) {
+  case 1:
+    for (std::size_t i = 0; i < count; i++) {
+      board[i] = static_cast<std::byte>(cards[i]);
+    }
+    break;
+
+  case 2: {
+    auto *ids = reinterpret_cast<std::uint16_t *>(board);
+    for (std::size_t i = 0; i < count; i++) {
+      ids[i] = static_cast<std::uint16_t>(cards[i]);
+    }
+    break;
+  }
+
+  default:
+    std::memcpy(board, cards, count * sizeof(CardId));
+    break;
+  }
+}
+
+DealChecker::DealChecker(std::uint64_t pair_count, bool wrapped)
+    : m_PairCount(pair_count), m_Wrapped(wrapped),
+      m_Counts(wrapped ? std::min<std::uint64_t>(pair_count, 256)
+                       : pair_count) {}
+
+bool DealChecker::Add(CardId id) {
+  if (id >= m_Counts.size()) {
+    return false;
+  }
+
+  // Pairs id, id + 256, id + 512 ... below the pair count share a wrapped id
+  const std::uint64_t expected =
+      m_Wrapped ? 2 * ((m_PairCount - 1 - id) / 256 + 1) : 2;
+
+  return ++m_Counts[id] <= expected;
+}
+
+bool IsSaveImage(std::span<const std::byte> image) {
+  return image.size() >= sizeof(kSaveMagic) &&
+         std::memcmp(image.data(), kSaveMagic, sizeof(kSaveMagic)) == 0;
+}
+
+void SealSaveImage(std::span<std::byte> image) {
+  auto &header = *reinterpret_cast<SaveHeader *>(image.data());
+
+  std::memcpy(header.magic, kSaveMagic, sizeof(kSaveMagic));
+  header.version = kSaveVersion;
+  header.header_size = sizeof(SaveHeader);
+  header.body_size = image.size() - sizeof(SaveHeader);
+  header.body_crc = Crc32(image.subspan(sizeof(SaveHeader)));
+  header.header_crc = Crc32(image.first(kHeaderCrcSize));
+}
+
+std::uint32_t Crc32(std::span<const std::byte> data) {
+  std::uint32_t crc = 0xFFFFFFFFu;
+
+  for (const std::byte byte : data) {
+    crc = kCrc32Table[(crc ^ static_cast<std::uint8_t>(byte)) & 0xFF] ^
+          (crc >> 8);
+  }
+
+  return crc ^ 0xFFFFFFFFu;
+}
+
+} // namespace memory_game
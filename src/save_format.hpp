@@ -0,0 +1,185 @@
+/*
+ *
+ * On-disk save format, version 2.
+ *
+ * A save file is a 64 byte header followed by a fixed-layout body. All
+ * integers are little endian. Every body section starts at a multiple of 8
+ * bytes from the start of the file, so a memory mapped save can be read by
+ * casting pointers into it without any parsing.
+ *
+ * Header:
+ *   offset  size  field
+ *        0     8  magic "MEMSAVE\0"
+ *        8     4  format version (2, version 1 files still load)
+ *       12     4  header size in bytes (64)
+ *       16     4  board size (cards per row and per column)
+ *       20     4  player count
+ *       24     4  game status (GameStatus)
+ *       28     4  current player index
+ *       32     4  first selected card x
+ *       36     4  first selected card y
+ *       40     4  turn number
+ *       44     4  card width in bytes: 1, 2 or 4 (0 in version 1)
+ *       48     8  body size in bytes
+ *       56     4  CRC-32 of the body
+ *       60     4  CRC-32 of header bytes 0..59
+ *
+ * Body (each section zero padded to a multiple of 8 bytes):
+ *   matched cards count per player  player count x uint32
+ *   board                           board size^2 x card id of card width
+ *                                   bytes, index x * size + y
+ *   revealed mask                   ceil(board size^2 / 64) x uint64
+ *   matched mask                    ceil(board size^2 / 64) x uint64
+ *
+ * Bit i of a mask is bit i % 64 of word i / 64.
+ *
+ * Card ids are stored in the narrowest width that holds every pair of the
+ * board (see GetCardWidth). Version 1 stored the character 'A' + id, one byte
+ * per card.
+ *
+ * Files without the magic are treated as the original headerless format.
+ *
+ */
+
+#pragma once
+
+// local
+#include "card.hpp"
+
+// std
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace memory_game {
+
+static_assert(std::endian::native == std::endian::little,
+              "Save format is read by casting pointers into little endian data");
+
+// Magic at the start of every save file
+inline constexpr char kSaveMagic[8] = {'M', 'E', 'M', 'S', 'A', 'V', 'E', '\0'};
+
+// Current save format version
+inline constexpr std::uint32_t kSaveVersion = 2;
+
+// Largest board size accepted when loading
+inline constexpr std::uint32_t kMaxSaveBoardSize = 1u << 14;
+
+// Largest player count accepted when loading
+inline constexpr std::uint32_t kMaxSavePlayerCount = 1u << 16;
+
+// Save file header, see the layout above
+struct SaveHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t header_size;
+  std::uint32_t board_size;
+  std::uint32_t player_count;
+  std::uint32_t game_status;
+  std::uint32_t player_index;
+  std::uint32_t previous_x;
+  std::uint32_t previous_y;
+  std::uint32_t turn_number;
+  std::uint32_t card_width;
+  std::uint64_t body_size;
+  std::uint32_t body_crc;
+  std::uint32_t header_crc;
+};
+
+static_assert(sizeof(SaveHeader) == 64, "Save header must be 64 bytes");
+
+// Byte offsets of the sections of a save file
+struct SaveLayout {
+  std::size_t counts_offset;
+  std::size_t board_offset;
+  std::size_t revealed_offset;
+  std::size_t matched_offset;
+  std::size_t mask_words; // Words in each mask
+  std::size_t card_width; // Bytes per card on the board
+  std::size_t file_size;
+
+  // Compute layout for a game saved with card_width bytes per card
+  static SaveLayout For(std::uint32_t board_size, std::uint32_t player_count,
+                        std::uint32_t card_width);
+};
+
+// Validated, read-only view of a save image (usually a memory mapped file)
+class SaveView {
+public:
+  // Check header, sizes, checksums and that the board holds every pair
+  // exactly twice. Returns std::nullopt and sets error if the image is not a
+  // valid save.
+  static std::optional<SaveView> Parse(std::span<const std::byte> image,
+                                       std::string &error);
+
+  const SaveHeader &GetHeader() const { return *m_Header; }
+
+  const std::uint32_t *GetMatchedCounts() const {
+    return Section<std::uint32_t>(m_Layout.counts_offset);
+  }
+
+  // Copy the board's card ids into cards, board size^2 of them
+  void CopyBoard(CardId *cards) const;
+
+  const std::uint64_t *GetRevealedWords() const {
+    return Section<std::uint64_t>(m_Layout.revealed_offset);
+  }
+
+  const std::uint64_t *GetMatchedWords() const {
+    return Section<std::uint64_t>(m_Layout.matched_offset);
+  }
+
+  // Words in each mask
+  std::size_t GetMaskWords() const { return m_Layout.mask_words; }
+
+private:
+  SaveView(const std::byte *image, const SaveLayout &layout)
+      : m_Header(reinterpret_cast<const SaveHeader *>(image)), m_Image(image),
+        m_Layout(layout) {}
+
+  template <typename T> const T *Section(std::size_t offset) const {
+    return reinterpret_cast<const T *>(m_Image + offset);
+  }
+
+  const SaveHeader *m_Header;
+  const std::byte *m_Image;
+  SaveLayout m_Layout;
+};
+
+// Checks that the card ids of a board are a complete deal: every id below the
+// pair count and each pair exactly twice. Ids of version 1 and legacy saves
+// were stored as the character 'A' + id and wrapped around past 255, so with
+// wrapped set every wrapped id is expected once for each pair it stands for.
+class DealChecker {
+public:
+  DealChecker(std::uint64_t pair_count, bool wrapped);
+
+  // Count id, false if it's out of range or seen more often than expected.
+  // Once 2 x pair count ids were added without failing the deal is complete.
+  bool Add(CardId id);
+
+private:
+  std::uint64_t m_PairCount;
+  bool m_Wrapped;
+  std::vector<std::uint32_t> m_Counts;
+};
+
+// Whether image starts with the save magic
+bool IsSaveImage(std::span<const std::byte> image);
+
+// Write card ids into the board section of image at layout's card width
+void StoreBoard(std::span<std::byte> image, const SaveLayout &layout,
+                const CardId *cards, std::size_t count);
+
+// Fill in size and checksum fields of a save image whose header and body are
+// otherwise complete
+void SealSaveImage(std::span<std::byte> image);
+
+// CRC-32 (IEEE 802.3) of data
+std::uint32_t Crc32(std::span<const std::byte> data);
+
+} // namespace memory_game
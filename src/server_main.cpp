@@ -0,0 +1,91 @@
+/*
+ *
+ * Game server.
+ *
+ * Hosts many games in one process and serves them over a Unix domain socket,
+ * see session_server.hpp for the protocol. Runs until interrupted.
+ *
+ * Usage: memory_server [--socket PATH] [--threads N]
+ *
+ */
+
+// local
+#include "common.hpp"
+#include "session_server.hpp"
+
+// std
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: memory_server [--socket PATH] [--threads N]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string socket_path = "memory_server.sock";
+  std::uint32_t thread_count = 0;
+
+  // Parse arguments
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+
+    const char *value = argv[++i];
+
+    bool valid = true;
+
+    if (arg == "--socket") {
+      socket_path = value;
+    } else if (arg == "--threads") {
+      valid = parse_number(value, thread_count);
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Handle termination signals synchronously on this thread. Blocked before
+  // any thread starts so every thread inherits the mask.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  try {
+    memory_game::SessionHost host(thread_count);
+    memory_game::SessionServer server(host, socket_path);
+
+    std::cout << "Serving on " << socket_path << " with "
+              << host.GetShardCount() << " shards" << std::endl;
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+
+    server.Stop();
+    std::cout << "Stopped with " << host.GetSessionCount() << " open sessions"
+              << std::endl;
+  } catch (const std::system_error &error) {
+    std::cerr << error.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+// header
+#include "session_host.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <utility>
+
+namespace memory_game {
+
+namespace {
+
+// Slab size for a typical game. Bigger games overflow to the heap.
+constexpr std::size_t kSlabSize = 1024;
+
+} // namespace
+
+/* SessionHost */
+
+SessionHost::SessionHost(std::uint32_t shard_count) {
+  if (shard_count == 0) {
+    shard_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (std::uint32_t i = 0; i < shard_count; i++) {
+    m_Shards.push_back(std::make_unique<Shard>());
+  }
+}
+
+SessionHost::~SessionHost() = default;
+
+void SessionHost::Submit(SessionRequest request, Callback done) {
+  // New sessions get an id here so the owning shard is known up front
+  if (request.type == SessionRequest::Type::create) {
+    request.session = m_NextSession.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ShardFor(request.session).Push({std::move(request), std::move(done)});
+}
+
+SessionReply SessionHost::Execute(SessionRequest request) {
+  std::promise<SessionReply> promise;
+  std::future<SessionReply> reply = promise.get_future();
+
+  Submit(std::move(request), [&promise](SessionReply result) {
+    promise.set_value(std::move(result));
+  });
+
+  return reply.get();
+}
+
+std::size_t SessionHost::GetSessionCount() const {
+  std::size_t count = 0;
+  for (const auto &shard : m_Shards) {
+    count += shard->GetSessionCount();
+  }
+  return count;
+}
+
+/* SessionHost::Shard */
+
+SessionHost::Shard::Shard() : m_Pool(kSlabSize), m_Thread([this] { Run(); }) {}
+
+SessionHost::Shard::~Shard() {
+  m_Stopping.store(true, std::memory_order_release);
+  m_Signal.fetch_add(1, std::memory_order_release);
+  m_Signal.notify_one();
+
+  m_Thread.join();
+}
+
+void SessionHost::Shard::Push(Task task) {
+  m_Queue.Push(std::move(task));
+
+  m_Signal.fetch_add(1, std::memory_order_release);
+  m_Signal.notify_one();
+}
+
+void SessionHost::Shard::Run() {
+  for (;;) {
+    // Read the signal before draining, a push after the drain changes it and
+    // the wait below returns immediately
+    const std::uint32_t signal = m_Signal.load(std::memory_order_acquire);
+
+    while (std::optional<Task> task = m_Queue.Pop()) {
+      task->done(Handle(task->request));
+    }
+
+    if (m_Stopping.load(std::memory_order_acquire)) {
+      // Free the games before the pool their slabs go back to
+      m_Sessions.clear();
+      return;
+    }
+
+    m_Signal.wait(signal, std::memory_order_acquire);
+  }
+}
+
+SessionReply SessionHost::Shard::Handle(const SessionRequest &request) {
+  SessionReply reply{};
+  reply.session = request.session;
+
+  try {
+    if (request.type == SessionRequest::Type::create) {
+      // The board is filled with pairs
+      if (request.board_size == 0 || request.board_size % 2 != 0 ||
+          request.board_size > kMaxBoardSize || request.player_count == 0 ||
+          request.player_count > kMaxPlayerCount) {
+        reply.error = "Invalid board size or player count";
+        return reply;
+      }
+
+      auto session = std::make_unique<Session>(m_Pool, request.board_size,
+                                               request.player_count);
+      session->logic.SetGameId(request.session);
+      if (request.seed) {
+        session->logic.InitializeBoard(*request.seed);
+      }
+
+      m_Sessions.emplace(request.session, std::move(session));
+      m_SessionCount.store(m_Sessions.size(), std::memory_order_relaxed);
+
+      reply.ok = true;
+      return reply;
+    }
+
+    const auto it = m_Sessions.find(request.session);
+    if (it == m_Sessions.end()) {
+      reply.error = "Unknown session";
+      return reply;
+    }
+
+    MemoryLogic &logic = it->second->logic;
+
+    switch (request.type) {
+    case SessionRequest::Type::select:
+      if (request.x >= logic.GetBoardSize() ||
+          request.y >= logic.GetBoardSize()) {
+        reply.error = "Card coordinates exceed board size";
+        return reply;
+      }
+
+      logic.SelectCard(request.x, request.y);
+      if (logic.GetHasCardBeenRevealed()[request.x][request.y]) {
+        reply.card = logic.GetBoard()[request.x][request.y];
+      }
+      break;
+
+    case SessionRequest::Type::state:
+      reply.face_down_count = logic.GetFaceDownCardsCount();
+      if (logic.GetGameStatus() == GameStatus::gameFinished) {
+        reply.winners = logic.GetWinners();
+      }
+      break;
+
+    case SessionRequest::Type::close:
+      m_Sessions.erase(it);
+      m_SessionCount.store(m_Sessions.size(), std::memory_order_relaxed);
+      reply.ok = true;
+      return reply;
+
+    case SessionRequest::Type::create:
+      break;
+    }
+
+    reply.status = logic.GetGameStatus();
+    reply.player_index = logic.GetCurrentPlayerIndex();
+    reply.turn_number = logic.GetTurnNumber();
+    reply.ok = true;
+  } catch (const std::exception &error) {
+    reply.ok = false;
+    reply.error = error.what();
+  }
+
+  return reply;
+}
+
+const char *GetStatusName(GameStatus status) {
+  switch (status) {
+  case GameStatus::selectingFirstCard:
+    return "first";
+  case GameStatus::selectingSecondCard:
+    return "second";
+  case GameStatus::cardsDidntMatch:
+    return "mismatch";
+  case GameStatus::gameFinished:
+    return "finished";
+  }
+
+  return "unknown";
+}
+
+} // namespace memory_game
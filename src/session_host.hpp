@@ -0,0 +1,174 @@
+#pragma once
+
+// local
+#include "game_arena.hpp"
+#include "memory_logic.hpp"
+#include "mpsc_queue.hpp"
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace memory_game {
+
+// Identifier of a hosted game
+using SessionId = std::uint64_t;
+
+// Request to the session host
+struct SessionRequest {
+  enum class Type {
+    create, // Start a new game
+    select, // Select card (x, y), like a key press in the UI
+    state,  // Query the game state
+    close,  // End the game and free its state
+  };
+
+  Type type = Type::state;
+  SessionId session = 0; // Ignored by create
+
+  std::uint32_t x = 0; // select
+  std::uint32_t y = 0; // select
+
+  std::uint32_t board_size = 4;           // create
+  std::uint32_t player_count = 2;         // create
+  std::optional<std::uint64_t> seed = {}; // create, random if not set
+};
+
+// Result of a request
+struct SessionReply {
+  bool ok = false;
+  std::string error{}; // Set if not ok
+
+  SessionId session = 0;
+
+  GameStatus status = GameStatus::selectingFirstCard;
+  std::uint32_t player_index = 0;
+  std::uint32_t turn_number = 0;
+
+  // select: card at the selected position, only set while it's face up so
+  // clients can't peek at hidden cards
+  std::optional<CardId> card = {};
+
+  std::uint32_t face_down_count = 0;   // state: cards not yet revealed
+  std::vector<std::uint32_t> winners{}; // state: set once the game finished
+};
+
+// Hosts many games in one process.
+//
+// Games are spread over shards, one per worker thread, by session id. Every
+// request for a game runs on the thread of its shard, so game state needs no
+// locking and shards never share a lock. Requests reach a shard through a
+// lock-free queue. Each shard allocates its games' state from its own pool of
+// arena slabs, so ending a game frees its memory in O(1) and the slab is
+// reused by the next game on that shard.
+class SessionHost {
+public:
+  // Called with the reply on the shard's thread. Must not block.
+  using Callback = std::function<void(SessionReply)>;
+
+  // Largest board size a session may use
+  static constexpr std::uint32_t kMaxBoardSize = 256;
+
+  // Largest player count a session may use
+  static constexpr std::uint32_t kMaxPlayerCount = 64;
+
+  // Start shard_count shards, 0 means one per hardware thread
+  explicit SessionHost(std::uint32_t shard_count = 0);
+
+  SessionHost(const SessionHost &) = delete;
+  SessionHost &operator=(const SessionHost &) = delete;
+
+  // Finish queued requests and stop the shards. Nothing may submit anymore.
+  ~SessionHost();
+
+  // Queue request. Safe to call from any thread.
+  void Submit(SessionRequest request, Callback done);
+
+  // Submit request and wait for the reply
+  SessionReply Execute(SessionRequest request);
+
+  // Return number of shards
+  std::uint32_t GetShardCount() const {
+    return static_cast<std::uint32_t>(m_Shards.size());
+  }
+
+  // Return number of open sessions
+  std::size_t GetSessionCount() const;
+
+private:
+  // One hosted game. The arena is declared first so it outlives the game.
+  struct Session {
+    Session(SlabPool &pool, std::uint32_t board_size,
+            std::uint32_t player_count)
+        : arena(pool), logic(board_size, player_count, &arena) {}
+
+    GameArena arena;
+    MemoryLogic logic;
+  };
+
+  struct Task {
+    SessionRequest request;
+    Callback done;
+  };
+
+  // Worker thread with the games it owns
+  class Shard {
+  public:
+    Shard();
+
+    // Finish queued tasks and join the thread
+    ~Shard();
+
+    // Queue task, safe to call from any thread
+    void Push(Task task);
+
+    // Return number of sessions owned by the shard
+    std::size_t GetSessionCount() const {
+      return m_SessionCount.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // Worker thread loop
+    void Run();
+
+    // Run request and return the reply
+    SessionReply Handle(const SessionRequest &request);
+
+    MpscQueue<Task> m_Queue{};
+
+    // Bumped after every push so the worker can sleep on it without missing
+    // a task
+    std::atomic<std::uint32_t> m_Signal{0};
+    std::atomic<bool> m_Stopping{false};
+
+    SlabPool m_Pool; // Declared first so sessions are freed before it
+
+    // Only touched by the worker thread
+    std::unordered_map<SessionId, std::unique_ptr<Session>> m_Sessions{};
+
+    std::atomic<std::size_t> m_SessionCount{0};
+
+    std::thread m_Thread; // Started last, once everything else is constructed
+  };
+
+  // Return shard owning session
+  Shard &ShardFor(SessionId session) {
+    return *m_Shards[session % m_Shards.size()];
+  }
+
+  std::vector<std::unique_ptr<Shard>> m_Shards{};
+
+  std::atomic<SessionId> m_NextSession{1};
+};
+
+// Return short name of status used by the text protocol
+const char *GetStatusName(GameStatus status);
+
+} // namespace memory_game
@@ -0,0 +1,478 @@
+// header
+#include "session_server.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace memory_game {
+
+namespace {
+
+// Longest request line accepted
+constexpr std::size_t kMaxLineLength = 4096;
+
+// Most reply bytes queued for a client before it's dropped
+constexpr std::size_t kMaxQueuedReplyBytes = 1 << 20;
+
+// Split line into whitespace separated words
+std::vector<std::string_view> SplitWords(std::string_view line) {
+  std::vector<std::string_view> words;
+
+  while (!line.empty()) {
+    const std::size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) {
+      break;
+    }
+
+    line.remove_prefix(start);
+    const std::size_t end = std::min(line.find_first_of(" \t\r"), line.size());
+    words.push_back(line.substr(0, end));
+    line.remove_prefix(end);
+  }
+
+  return words;
+}
+
+// Parse whole word as an unsigned number
+template <typename T> bool ParseNumber(std::string_view word, T &value) {
+  const auto [end, ec] =
+      std::from_chars(word.data(), word.data() + word.size(), value);
+  return ec == std::errc{} && end == word.data() + word.size();
+}
+
+// Format reply to a request
+std::string FormatReply(const std::string &tag, SessionRequest::Type type,
+                        const SessionReply &reply) {
+  // Appended piece by piece, chained operator+ on temporaries trips GCC's
+  // -Wrestrict in optimised builds
+  std::string line = tag;
+
+  if (!reply.ok) {
+    line += " error ";
+    line += reply.error;
+    line += '\n';
+    return line;
+  }
+
+  line += " ok";
+
+  // Fields shared by select and state replies
+  const auto append_game = [&] {
+    line += ' ';
+    line += GetStatusName(reply.status);
+    line += ' ';
+    line += std::to_string(reply.player_index);
+    line += ' ';
+    line += std::to_string(reply.turn_number);
+    line += ' ';
+  };
+
+  switch (type) {
+  case SessionRequest::Type::create:
+    line += ' ';
+    line += std::to_string(reply.session);
+    break;
+
+  case SessionRequest::Type::select:
+    append_game();
+    line += reply.card ? std::to_string(*reply.card) : "-";
+    break;
+
+  case SessionRequest::Type::state: {
+    append_game();
+    line += std::to_string(reply.face_down_count);
+    line += ' ';
+
+    if (reply.winners.empty()) {
+      line += "-";
+    }
+    for (std::size_t i = 0; i < reply.winners.size(); i++) {
+      if (i != 0) {
+        line += ',';
+      }
+      line += std::to_string(reply.winners[i]);
+    }
+    break;
+  }
+
+  case SessionRequest::Type::close:
+    break;
+  }
+
+  line += '\n';
+  return line;
+}
+
+// Parse request words after the tag, returns false if malformed
+bool ParseRequest(const std::vector<std::string_view> &words,
+                  SessionRequest &request) {
+  const std::string_view command = words[1];
+
+  if (command == "new" && (words.size() == 4 || words.size() == 5)) {
+    request.type = SessionRequest::Type::create;
+
+    if (words.size() == 5) {
+      std::uint64_t seed = 0;
+      if (!ParseNumber(words[4], seed)) {
+        return false;
+      }
+      request.seed = seed;
+    }
+
+    return ParseNumber(words[2], request.board_size) &&
+           ParseNumber(words[3], request.player_count);
+  }
+
+  if (command == "select" && words.size() == 5) {
+    request.type = SessionRequest::Type::select;
+    return ParseNumber(words[2], request.session) &&
+           ParseNumber(words[3], request.x) && ParseNumber(words[4], request.y);
+  }
+
+  if (command == "state" && words.size() == 3) {
+    request.type = SessionRequest::Type::state;
+    return ParseNumber(words[2], request.session);
+  }
+
+  if (command == "close" && words.size() == 3) {
+    request.type = SessionRequest::Type::close;
+    return ParseNumber(words[2], request.session);
+  }
+
+  return false;
+}
+
+} // namespace
+
+/* SessionServer::Connection */
+
+SessionServer::Connection::Connection(int fd) : fd(fd) {
+  if (pipe(wake_fds) != 0) {
+    const int error = errno;
+    close(fd);
+    throw std::system_error(error, std::generic_category(), "pipe");
+  }
+
+  for (const int wake_fd : wake_fds) {
+    fcntl(wake_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(wake_fd, F_SETFL, fcntl(wake_fd, F_GETFL) | O_NONBLOCK);
+  }
+}
+
+SessionServer::Connection::~Connection() {
+  close(fd);
+  close(wake_fds[0]);
+  close(wake_fds[1]);
+}
+
+void SessionServer::Connection::Send(const std::string &line) {
+  std::lock_guard lock(mutex);
+
+  if (failed) {
+    return;
+  }
+
+  // The connection's thread is already waiting for room to send the queue
+  if (!outgoing.empty()) {
+    outgoing += line;
+
+    // The client stopped reading its replies
+    if (outgoing.size() > kMaxQueuedReplyBytes) {
+      FailLocked();
+    }
+    return;
+  }
+
+  outgoing = line;
+  FlushLocked();
+
+  // Wake the connection's thread to send the rest once the socket has room
+  if (!failed && !outgoing.empty()) {
+    const char wake = 0;
+    [[maybe_unused]] const ssize_t result = write(wake_fds[1], &wake, 1);
+  }
+}
+
+void SessionServer::Connection::FlushLocked() {
+  std::size_t written = 0;
+
+  while (written < outgoing.size()) {
+    // MSG_NOSIGNAL: a client that hung up must not kill the server
+    const ssize_t result =
+        send(fd, outgoing.data() + written, outgoing.size() - written,
+             MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    if (result <= 0) {
+      FailLocked();
+      return;
+    }
+
+    written += static_cast<std::size_t>(result);
+  }
+
+  outgoing.erase(0, written);
+}
+
+void SessionServer::Connection::FailLocked() {
+  failed = true;
+  outgoing.clear();
+
+  // Wakes the connection's thread, which then reads end of file
+  shutdown(fd, SHUT_RDWR);
+}
+
+void SessionServer::Connection::Finish(SessionRequest::Type type,
+                                       const SessionReply &reply) {
+  std::lock_guard lock(mutex);
+
+  if (reply.ok && type == SessionRequest::Type::create) {
+    sessions.insert(reply.session);
+  } else if (reply.ok && type == SessionRequest::Type::close) {
+    sessions.erase(reply.session);
+  }
+
+  if (--in_flight == 0) {
+    answered.notify_all();
+  }
+}
+
+/* SessionServer */
+
+SessionServer::SessionServer(SessionHost &host,
+                             const std::filesystem::path &socket_path)
+    : m_Host(host), m_SocketPath(socket_path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+
+  const std::string path = m_SocketPath.string();
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                            "Socket path too long");
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  m_ListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_ListenFd < 0) {
+    throw std::system_error(errno, std::generic_category(), "socket");
+  }
+
+  // A previous server that crashed leaves its socket file behind
+  unlink(path.c_str());
+
+  if (bind(m_ListenFd, reinterpret_cast<const sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      listen(m_ListenFd, SOMAXCONN) != 0) {
+    const int error = errno;
+    close(m_ListenFd);
+    throw std::system_error(error, std::generic_category(), "bind " + path);
+  }
+
+  m_AcceptThread = std::thread([this] { AcceptLoop(); });
+}
+
+SessionServer::~SessionServer() {
+  Stop();
+
+  close(m_ListenFd);
+  unlink(m_SocketPath.c_str());
+}
+
+void SessionServer::Stop() {
+  if (m_Stopping.exchange(true)) {
+    return;
+  }
+
+  // Wake accept() and every blocked read()
+  shutdown(m_ListenFd, SHUT_RDWR);
+  m_AcceptThread.join();
+
+  std::list<Client> clients;
+  {
+    std::lock_guard lock(m_ClientsMutex);
+    clients.swap(m_Clients);
+  }
+
+  for (Client &client : clients) {
+    shutdown(client.connection->fd, SHUT_RDWR);
+  }
+
+  for (Client &client : clients) {
+    client.thread.join();
+  }
+}
+
+void SessionServer::AcceptLoop() {
+  while (!m_Stopping.load()) {
+    const int fd = accept4(m_ListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      return;
+    }
+
+    ReapConnections();
+
+    std::shared_ptr<Connection> connection;
+    try {
+      connection = std::make_shared<Connection>(fd);
+    } catch (const std::system_error &) {
+      continue;
+    }
+
+    std::lock_guard lock(m_ClientsMutex);
+    m_Clients.push_back(
+        {connection, std::thread([this, connection] { Serve(connection); })});
+  }
+}
+
+void SessionServer::Serve(const std::shared_ptr<Connection> &connection) {
+  std::string buffer;
+  char chunk[4096];
+
+  for (;;) {
+    bool sending = false;
+    {
+      std::lock_guard lock(connection->mutex);
+      sending = !connection->outgoing.empty();
+    }
+
+    pollfd fds[2] = {
+        {connection->fd,
+         static_cast<short>(POLLIN | (sending ? POLLOUT : 0)), 0},
+        {connection->wake_fds[0], POLLIN, 0},
+    };
+
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    // Replies were queued, the next poll waits for room to send them
+    if (fds[1].revents & POLLIN) {
+      char wakes[64];
+      while (read(connection->wake_fds[0], wakes, sizeof(wakes)) > 0) {
+      }
+    }
+
+    if (fds[0].revents & POLLOUT) {
+      std::lock_guard lock(connection->mutex);
+      connection->FlushLocked();
+    }
+
+    if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+      continue;
+    }
+
+    const ssize_t length = read(connection->fd, chunk, sizeof(chunk));
+    if (length < 0 && errno == EINTR) {
+      continue;
+    }
+    if (length <= 0) {
+      break;
+    }
+
+    buffer.append(chunk, static_cast<std::size_t>(length));
+
+    // Handle every complete line
+    std::size_t start = 0;
+    for (std::size_t end = buffer.find('\n'); end != std::string::npos;
+         end = buffer.find('\n', start)) {
+      HandleLine(connection,
+                 std::string_view(buffer).substr(start, end - start));
+      start = end + 1;
+    }
+    buffer.erase(0, start);
+
+    // Drop clients that never finish a line
+    if (buffer.size() > kMaxLineLength) {
+      break;
+    }
+  }
+
+  // Close the sessions the client created once its requests are answered,
+  // nothing else would ever close them
+  std::unique_lock lock(connection->mutex);
+  connection->answered.wait(lock, [&] { return connection->in_flight == 0; });
+
+  std::unordered_set<SessionId> sessions;
+  sessions.swap(connection->sessions);
+  connection->in_flight = sessions.size();
+  lock.unlock();
+
+  for (const SessionId session : sessions) {
+    SessionRequest request{};
+    request.type = SessionRequest::Type::close;
+    request.session = session;
+
+    m_Host.Submit(std::move(request), [connection](SessionReply reply) {
+      connection->Finish(SessionRequest::Type::close, reply);
+    });
+  }
+
+  lock.lock();
+  connection->answered.wait(lock, [&] { return connection->in_flight == 0; });
+
+  connection->done.store(true);
+}
+
+void SessionServer::HandleLine(const std::shared_ptr<Connection> &connection,
+                               std::string_view line) {
+  const std::vector<std::string_view> words = SplitWords(line);
+  if (words.empty()) {
+    return;
+  }
+
+  std::string tag(words[0]);
+
+  SessionRequest request{};
+  if (words.size() < 2 || !ParseRequest(words, request)) {
+    connection->Send(tag + " error Malformed request\n");
+    return;
+  }
+
+  {
+    std::lock_guard lock(connection->mutex);
+    connection->in_flight++;
+  }
+
+  const SessionRequest::Type type = request.type;
+  m_Host.Submit(std::move(request), [connection, tag = std::move(tag),
+                                     type](SessionReply reply) {
+    connection->Send(FormatReply(tag, type, reply));
+    connection->Finish(type, reply);
+  });
+}
+
+void SessionServer::ReapConnections() {
+  std::lock_guard lock(m_ClientsMutex);
+
+  for (auto it = m_Clients.begin(); it != m_Clients.end();) {
+    if (it->connection->done.load()) {
+      it->thread.join();
+      it = m_Clients.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace memory_game
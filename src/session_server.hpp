@@ -0,0 +1,130 @@
+/*
+ *
+ * Local socket front end for SessionHost (POSIX only).
+ *
+ * Clients connect to a Unix domain stream socket and send one request per
+ * line. Every request starts with a client chosen tag that is echoed in the
+ * reply, so a client may pipeline requests and match replies that arrive out
+ * of order (requests for different games run on different shards).
+ *
+ *   <tag> new <board size> <player count> [seed]  -> <tag> ok <session>
+ *   <tag> select <session> <x> <y>
+ *                            -> <tag> ok <status> <player> <turn> <card>
+ *   <tag> state <session>
+ *          -> <tag> ok <status> <player> <turn> <face down count> <winners>
+ *   <tag> close <session>                         -> <tag> ok
+ *
+ * <status> is first, second, mismatch or finished. <card> is the number of
+ * the card at (x, y), equal numbers are a pair, or - if the card is face
+ * down after the selection (selecting while in mismatch only turns the pair
+ * back over). <winners> is a comma separated list of player indices, or -
+ * while the game runs. A failed request is answered with
+ * "<tag> error <message>".
+ *
+ * Sessions are closed when the connection that created them goes away.
+ *
+ * Replies are queued per connection and never block the game threads. A
+ * client that lets more than 1 MiB of replies pile up unread is disconnected.
+ *
+ */
+
+#pragma once
+
+// local
+#include "session_host.hpp"
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+namespace memory_game {
+
+class SessionServer {
+public:
+  // Listen on socket_path, replacing a stale socket file. Throws
+  // std::system_error if the socket can't be created.
+  SessionServer(SessionHost &host, const std::filesystem::path &socket_path);
+
+  SessionServer(const SessionServer &) = delete;
+  SessionServer &operator=(const SessionServer &) = delete;
+
+  // Stop serving and remove the socket file
+  ~SessionServer();
+
+  // Stop accepting, disconnect clients and wait for their threads
+  void Stop();
+
+private:
+  // Connected client. Shared with the callbacks of its pending requests,
+  // which queue their replies from the shard threads.
+  struct Connection {
+    // Take ownership of fd. Throws std::system_error if the wake pipe can't
+    // be created.
+    explicit Connection(int fd);
+    ~Connection();
+
+    // Queue line and send as much of the queue as the socket takes without
+    // blocking. The connection's thread sends the rest.
+    void Send(const std::string &line);
+
+    // Send queued replies until the socket is full. Caller holds mutex.
+    void FlushLocked();
+
+    // Drop the client, its thread sees the socket close
+    void FailLocked();
+
+    // Record that the request of type was answered with reply
+    void Finish(SessionRequest::Type type, const SessionReply &reply);
+
+    const int fd;
+    int wake_fds[2] = {-1, -1}; // Written when replies wait for room
+
+    std::mutex mutex;
+    std::condition_variable answered;  // Signalled when in_flight drops to 0
+    std::string outgoing{};            // Unsent replies, guarded by mutex
+    bool failed = false;               // Guarded by mutex
+    std::size_t in_flight = 0;         // Unanswered requests, guarded by mutex
+    std::unordered_set<SessionId> sessions{}; // Created here, guarded by mutex
+
+    std::atomic<bool> done{false}; // Reader thread finished
+  };
+
+  // Accept clients until stopped
+  void AcceptLoop();
+
+  // Read requests from connection and send its queued replies until it's
+  // closed, then close the sessions it created
+  void Serve(const std::shared_ptr<Connection> &connection);
+
+  // Parse request line and submit it, replies are sent asynchronously
+  void HandleLine(const std::shared_ptr<Connection> &connection,
+                  std::string_view line);
+
+  // Join threads of connections that are gone
+  void ReapConnections();
+
+  SessionHost &m_Host;
+  std::filesystem::path m_SocketPath;
+  int m_ListenFd = -1;
+  std::atomic<bool> m_Stopping{false};
+
+  struct Client {
+    std::shared_ptr<Connection> connection;
+    std::thread thread;
+  };
+
+  std::mutex m_ClientsMutex;
+  std::list<Client> m_Clients{}; // Guarded by m_ClientsMutex
+
+  std::thread m_AcceptThread; // Started last, once everything else is ready
+};
+
+} // namespace memory_game
@@ -0,0 +1,110 @@
+/*
+ *
+ * Headless batch simulator.
+ *
+ * Plays many complete games in parallel with simulated players and prints
+ * throughput together with the distribution of turn counts and winners.
+ *
+ * Usage: memory_sim [--size N] [--players N] [--games N] [--threads N]
+ *                   [--seed N] [--policy random|perfect|optimal|
+ *                               limited:<capacity>|
+ *                               decay:<capacity>:<half life>]
+ *
+ */
+
+// local
+#include "common.hpp"
+#include "simulation.hpp"
+
+// std
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void PrintUsage() {
+  std::cerr << "Usage: memory_sim [--size N] [--players N] [--games N] "
+               "[--threads N] [--seed N] "
+               "[--policy random|perfect|optimal|limited:<capacity>|"
+               "decay:<capacity>:<half life>]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  memory_game::SimulationConfig config{};
+  std::string policy_name = "random";
+
+  // Parse arguments
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+
+    if (i + 1 >= argc) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+
+    const char *value = argv[++i];
+
+    bool valid = true;
+
+    if (arg == "--size") {
+      valid = parse_number(value, config.board_size);
+    } else if (arg == "--players") {
+      valid = parse_number(value, config.player_count);
+    } else if (arg == "--games") {
+      valid = parse_number(value, config.game_count);
+    } else if (arg == "--threads") {
+      valid = parse_number(value, config.thread_count);
+    } else if (arg == "--seed") {
+      valid = parse_number(value, config.seed);
+    } else if (arg == "--policy") {
+      policy_name = value;
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  config.policy_factory = memory_game::ParsePolicy(policy_name);
+
+  // The board is filled with pairs
+  if (!config.policy_factory || config.board_size == 0 ||
+      config.board_size % 2 != 0 || config.player_count == 0) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  const memory_game::SimulationResult result =
+      memory_game::RunSimulation(config);
+
+  std::cout << "Board size:   " << config.board_size << "x"
+            << config.board_size << "\n"
+            << "Players:      " << config.player_count << "\n"
+            << "Policy:       " << policy_name << "\n"
+            << "Threads:      " << result.thread_count << "\n"
+            << "Games:        " << result.game_count << "\n"
+            << "Elapsed:      " << result.elapsed_seconds << " s\n"
+            << "Throughput:   " << result.GamesPerSecond() << " games/s\n"
+            << "Mean turns:   " << result.MeanTurns() << "\n"
+            << "Tied games:   " << result.tied_games << "\n";
+
+  std::cout << "\nWins per player:\n";
+  for (std::size_t i = 0; i < result.wins.size(); i++) {
+    std::cout << "  Player " << i + 1 << ": " << result.wins[i] << "\n";
+  }
+
+  std::cout << "\nTurn distribution (turns: games):\n";
+  for (const auto &[turns, count] : result.turn_histogram) {
+    std::cout << "  " << turns << ": " << count << "\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,504 @@
+// header
+#include "simulation.hpp"
+
+// local
+#include "optimal_policy.hpp"
+
+// std
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace memory_game {
+
+/* RandomPolicy */
+
+void RandomPolicy::Reset(std::uint32_t board_size, std::uint64_t seed) {
+  m_BoardSize = board_size;
+  m_Rng.Seed(seed);
+}
+
+std::uint32_t RandomPolicy::ChooseCard(const MemoryLogic &logic) {
+  return RandomFaceDownCard(logic, nullptr);
+}
+
+std::uint32_t
+RandomPolicy::RandomFaceDownCard(const MemoryLogic &logic,
+                                 const DynamicPackedBoolArray *excluded) {
+  const DynamicPackedBoolArray &revealed =
+      logic.GetHasCardBeenRevealed().bits();
+  const std::size_t word_count = revealed.GetSizeInWords();
+  const std::size_t tail_bits = revealed.GetSizeInBits() % 64;
+
+  // Candidates of word w, bits past the end cleared
+  const auto candidates = [&](std::size_t w) {
+    std::uint64_t word = ~revealed.GetPtr()[w];
+    if (excluded != nullptr) {
+      word &= ~excluded->GetPtr()[w];
+    }
+    if (w + 1 == word_count && tail_bits != 0) {
+      word &= (std::uint64_t{1} << tail_bits) - 1;
+    }
+    return word;
+  };
+
+  std::uint32_t count = 0;
+  for (std::size_t w = 0; w < word_count; w++) {
+    count += std::popcount(candidates(w));
+  }
+
+  // Fall back to any face down card
+  if (count == 0 && excluded != nullptr) {
+    return RandomFaceDownCard(logic, nullptr);
+  }
+
+  // Pick the n-th candidate in index order
+  std::uint32_t n = UniformBelow(m_Rng, count);
+
+  for (std::size_t w = 0;; w++) {
+    std::uint64_t word = candidates(w);
+    const std::uint32_t word_count_set = std::popcount(word);
+
+    if (n >= word_count_set) {
+      n -= word_count_set;
+      continue;
+    }
+
+    for (; n != 0; n--) {
+      word &= word - 1;
+    }
+    return static_cast<std::uint32_t>(w * 64 + std::countr_zero(word));
+  }
+}
+
+/* LimitedMemoryPolicy */
+
+LimitedMemoryPolicy::LimitedMemoryPolicy(std::size_t capacity,
+                                         double half_life)
+    : m_Capacity(capacity),
+      m_Retention(half_life > 0.0 ? std::exp2(-1.0 / half_life) : 1.0) {}
+
+void LimitedMemoryPolicy::Reset(std::uint32_t board_size, std::uint64_t seed) {
+  RandomPolicy::Reset(board_size, seed);
+
+  const std::size_t cards = static_cast<std::size_t>(board_size) * board_size;
+
+  m_Memory.assign(cards, kUnknownCard);
+  m_Known.Resize(cards);
+  m_Known.SetToZero();
+  m_Age.assign(cards, 0);
+  m_NextAge = 0;
+  m_Newer.assign(cards, kNoCard);
+  m_Older.assign(cards, kNoCard);
+  m_Oldest = m_Newest = kNoCard;
+  m_RememberedCount = 0;
+  m_Cells.assign(cards / 2, {kNoCard, kNoCard});
+  m_Pairs.clear();
+  m_FirstIndex = kNoCard;
+
+  if (m_Retention < 1.0) {
+    m_Clock = 0;
+    m_FadesAt.assign(cards, 0);
+    m_Fading.clear();
+  }
+}
+
+std::uint32_t LimitedMemoryPolicy::ChooseCard(const MemoryLogic &logic) {
+  const auto revealed = logic.GetHasCardBeenRevealed();
+
+  if (m_Retention < 1.0) {
+    ForgetFaded();
+  }
+
+  if (logic.GetGameStatus() == GameStatus::selectingFirstCard) {
+    m_FirstIndex = kNoCard;
+
+    // Start with the oldest known pair still face down
+    for (const auto &[age, index] : m_Pairs) {
+      if (FindPartner(logic, index, m_Memory[index]) != kNoCard &&
+          !revealed[index / m_BoardSize][index % m_BoardSize]) {
+        return index;
+      }
+    }
+
+    // Pick an unseen card if nothing better is known
+    return RandomFaceDownCard(logic, &m_Known);
+  }
+
+  // Second card: play the partner of the first card if it's remembered
+  if (m_FirstIndex != kNoCard) {
+    const std::uint32_t partner = FindPartner(logic, m_FirstIndex, m_FirstCard);
+    if (partner != kNoCard) {
+      return partner;
+    }
+  }
+
+  return RandomFaceDownCard(logic, &m_Known);
+}
+
+void LimitedMemoryPolicy::Observe(std::uint32_t index, CardId card) {
+  // The first card turned this turn is the one selected in stage one
+  if (m_FirstIndex == kNoCard) {
+    m_FirstIndex = index;
+    m_FirstCard = card;
+  } else {
+    m_FirstIndex = kNoCard;
+  }
+
+  if (m_Capacity == 0) {
+    return;
+  }
+
+  if (m_Retention < 1.0) {
+    m_Clock++;
+
+    // Survive each later observation with chance m_Retention, seeing the
+    // card again starts over
+    const double chance =
+        static_cast<double>((m_Rng() >> 11) + 1) * 0x1.0p-53;
+    const double lifetime =
+        std::floor(std::log(chance) / std::log(m_Retention));
+
+    m_FadesAt[index] =
+        m_Clock + 1 + static_cast<std::uint64_t>(std::min(lifetime, 1e18));
+    m_Fading.emplace_back(m_FadesAt[index], index);
+    std::push_heap(m_Fading.begin(), m_Fading.end(), std::greater<>{});
+  }
+
+  if (m_Memory[index] != kUnknownCard) {
+    return;
+  }
+
+  Remember(index, card);
+
+  // Forget the oldest card when memory is full
+  if (m_RememberedCount > m_Capacity) {
+    Forget(m_Oldest);
+  }
+}
+
+void LimitedMemoryPolicy::ForgetFaded() {
+  while (!m_Fading.empty() && m_Fading.front().first <= m_Clock) {
+    const auto [fades_at, index] = m_Fading.front();
+    std::pop_heap(m_Fading.begin(), m_Fading.end(), std::greater<>{});
+    m_Fading.pop_back();
+
+    // Stale if the card was seen again since
+    if (m_FadesAt[index] == fades_at) {
+      Forget(index);
+    }
+  }
+}
+
+void LimitedMemoryPolicy::ObserveMatch(std::uint32_t first_index,
+                                       std::uint32_t second_index) {
+  Forget(first_index);
+  Forget(second_index);
+}
+
+void LimitedMemoryPolicy::Remember(std::uint32_t index, CardId card) {
+  m_Memory[index] = card;
+  m_Known.SetUnchecked(index, true);
+  m_Age[index] = m_NextAge++;
+
+  // Append to the list as the newest
+  m_Older[index] = m_Newest;
+  m_Newer[index] = kNoCard;
+  (m_Newest != kNoCard ? m_Newer[m_Newest] : m_Oldest) = index;
+  m_Newest = index;
+  m_RememberedCount++;
+
+  auto &cells = m_Cells[card];
+  cells[cells[0] == kNoCard ? 0 : 1] = index;
+
+  // Both cards of the pair are known, the other one is older
+  if (cells[0] != kNoCard && cells[1] != kNoCard) {
+    const std::uint32_t older = cells[0] == index ? cells[1] : cells[0];
+    const std::pair<std::uint64_t, std::uint32_t> pair{m_Age[older], older};
+    m_Pairs.insert(std::lower_bound(m_Pairs.begin(), m_Pairs.end(), pair),
+                   pair);
+  }
+}
+
+void LimitedMemoryPolicy::Forget(std::uint32_t index) {
+  const CardId card = m_Memory[index];
+  if (card == kUnknownCard) {
+    return;
+  }
+
+  auto &cells = m_Cells[card];
+  if (cells[0] != kNoCard && cells[1] != kNoCard) {
+    const std::uint32_t older =
+        m_Age[cells[0]] < m_Age[cells[1]] ? cells[0] : cells[1];
+    m_Pairs.erase(std::lower_bound(m_Pairs.begin(), m_Pairs.end(),
+                                   std::pair{m_Age[older], older}));
+  }
+  cells[cells[0] == index ? 0 : 1] = kNoCard;
+
+  // Unlink from the list
+  (m_Older[index] != kNoCard ? m_Newer[m_Older[index]] : m_Oldest) =
+      m_Newer[index];
+  (m_Newer[index] != kNoCard ? m_Older[m_Newer[index]] : m_Newest) =
+      m_Older[index];
+  m_RememberedCount--;
+
+  m_Known.SetUnchecked(index, false);
+  m_Memory[index] = kUnknownCard;
+}
+
+std::uint32_t LimitedMemoryPolicy::FindPartner(const MemoryLogic &logic,
+                                               std::uint32_t index,
+                                               CardId card) const {
+  const auto revealed = logic.GetHasCardBeenRevealed();
+
+  // A card has one partner, remembered or not
+  for (const std::uint32_t other : m_Cells[card]) {
+    if (other != kNoCard && other != index &&
+        !revealed[other / m_BoardSize][other % m_BoardSize]) {
+      return other;
+    }
+  }
+
+  return kNoCard;
+}
+
+PolicyFactory ParsePolicy(std::string_view name) {
+  if (name == "random") {
+    return [] { return std::make_unique<RandomPolicy>(); };
+  }
+
+  if (name == "perfect") {
+    return [] { return std::make_unique<PerfectMemoryPolicy>(); };
+  }
+
+  if (name == "optimal") {
+    return [] { return std::make_unique<OptimalPolicy>(); };
+  }
+
+  constexpr std::string_view limited = "limited:";
+  if (name.starts_with(limited)) {
+    std::size_t capacity = 0;
+    const auto digits = name.substr(limited.size());
+    const auto [end, ec] = std::from_chars(
+        digits.data(), digits.data() + digits.size(), capacity);
+
+    if (ec == std::errc{} && end == digits.data() + digits.size()) {
+      return [capacity] {
+        return std::make_unique<LimitedMemoryPolicy>(capacity);
+      };
+    }
+  }
+
+  constexpr std::string_view decay = "decay:";
+  if (name.starts_with(decay)) {
+    std::size_t capacity = 0;
+    double half_life = 0.0;
+    const auto digits = name.substr(decay.size());
+    const char *const last = digits.data() + digits.size();
+
+    const auto [colon, ec] =
+        std::from_chars(digits.data(), last, capacity);
+    if (ec == std::errc{} && colon != last && *colon == ':') {
+      const auto [end, half_life_ec] =
+          std::from_chars(colon + 1, last, half_life);
+
+      if (half_life_ec == std::errc{} && end == last && half_life > 0.0) {
+        return [capacity, half_life] {
+          return std::make_unique<LimitedMemoryPolicy>(capacity, half_life);
+        };
+      }
+    }
+  }
+
+  return {};
+}
+
+void ObserveSelection(const MemoryLogic &logic,
+                      std::span<const std::unique_ptr<MovePolicy>> policies,
+                      GameStatus status, std::uint32_t index,
+                      std::uint32_t &first_index) {
+  const std::uint32_t board_size = logic.GetBoardSize();
+  const std::uint32_t x = index / board_size;
+  const std::uint32_t y = index % board_size;
+
+  const CardId card = logic.GetBoard()[x][y];
+  for (const auto &policy : policies) {
+    if (policy != nullptr) {
+      policy->Observe(index, card);
+    }
+  }
+
+  if (status == GameStatus::selectingFirstCard) {
+    first_index = index;
+  } else if (logic.GetHasCardBeenMatched()[x][y]) {
+    for (const auto &policy : policies) {
+      if (policy != nullptr) {
+        policy->ObserveMatch(first_index, index);
+      }
+    }
+  }
+}
+
+/* Simulation */
+
+GameResult PlayGame(MemoryLogic &logic,
+                    std::vector<std::unique_ptr<MovePolicy>> &policies,
+                    std::uint64_t seed) {
+  logic.InitializeBoard(seed);
+
+  const std::uint32_t board_size = logic.GetBoardSize();
+
+  for (std::size_t i = 0; i < policies.size(); i++) {
+    policies[i]->Reset(board_size, MixSeed(seed + i + 1));
+  }
+
+  std::uint32_t first_index = 0;
+
+  while (logic.GetGameStatus() != GameStatus::gameFinished) {
+    const GameStatus status = logic.GetGameStatus();
+
+    // Any key press hides the mismatched cards
+    if (status == GameStatus::cardsDidntMatch) {
+      logic.SelectCard(0, 0);
+      continue;
+    }
+
+    const std::uint32_t index =
+        policies[logic.GetCurrentPlayerIndex()]->ChooseCard(logic);
+    const std::uint32_t x = index / board_size;
+    const std::uint32_t y = index % board_size;
+
+    logic.SelectCard(x, y);
+
+    if (logic.GetGameStatus() == status) {
+      throw std::logic_error("Policy selected a card that is face up");
+    }
+
+    // Show the card to every player
+    ObserveSelection(logic, policies, status, index, first_index);
+  }
+
+  return {logic.GetTurnNumber(), logic.GetWinners()};
+}
+
+void SimulationResult::Merge(const SimulationResult &other) {
+  game_count += other.game_count;
+
+  for (const auto &[turns, count] : other.turn_histogram) {
+    turn_histogram[turns] += count;
+  }
+
+  wins.resize(std::max(wins.size(), other.wins.size()), 0);
+  for (std::size_t i = 0; i < other.wins.size(); i++) {
+    wins[i] += other.wins[i];
+  }
+
+  tied_games += other.tied_games;
+}
+
+double SimulationResult::GamesPerSecond() const {
+  return elapsed_seconds > 0.0 ? game_count / elapsed_seconds : 0.0;
+}
+
+double SimulationResult::MeanTurns() const {
+  if (game_count == 0) {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (const auto &[turns, count] : turn_histogram) {
+    sum += static_cast<double>(turns) * count;
+  }
+  return sum / game_count;
+}
+
+SimulationResult RunSimulation(const SimulationConfig &config) {
+  std::uint32_t thread_count = config.thread_count;
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Every thread plays games thread_index, thread_index + thread_count, ...
+  // into its own result, so workers share nothing until the final merge
+  std::vector<SimulationResult> thread_results(thread_count);
+  std::vector<std::exception_ptr> thread_errors(thread_count);
+
+  const auto play_games = [&config, thread_count](std::uint32_t thread_index,
+                                                  SimulationResult &result) {
+    MemoryLogic logic(config.board_size, config.player_count);
+
+    std::vector<std::unique_ptr<MovePolicy>> policies;
+    for (std::uint32_t i = 0; i < config.player_count; i++) {
+      policies.push_back(config.policy_factory());
+    }
+
+    result.wins.assign(config.player_count, 0);
+
+    for (std::uint64_t game = thread_index; game < config.game_count;
+         game += thread_count) {
+      const GameResult game_result =
+          PlayGame(logic, policies, MixSeed(config.seed + game));
+
+      result.game_count++;
+      result.turn_histogram[game_result.turn_number]++;
+
+      for (const std::uint32_t winner : game_result.winners) {
+        result.wins[winner]++;
+      }
+
+      if (game_result.winners.size() > 1) {
+        result.tied_games++;
+      }
+    }
+  };
+
+  // Catch errors so they can be rethrown on the calling thread
+  const auto worker = [&](std::uint32_t thread_index) {
+    try {
+      play_games(thread_index, thread_results[thread_index]);
+    } catch (...) {
+      thread_errors[thread_index] = std::current_exception();
+    }
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (std::uint32_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(worker, i);
+  }
+
+  // The calling thread works too
+  worker(0);
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (const auto &error : thread_errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  SimulationResult result{};
+  for (const auto &thread_result : thread_results) {
+    result.Merge(thread_result);
+  }
+
+  result.thread_count = thread_count;
+  result.elapsed_seconds = std::chrono::duration<double>(end - start).count();
+
+  return result;
+}
+
+} // namespace memory_game
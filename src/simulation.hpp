@@ -0,0 +1,214 @@
+#pragma once
+
+// local
+#include "fast_rng.hpp"
+#include "memory_logic.hpp"
+
+// std
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace memory_game {
+
+// Decides which card a simulated player selects.
+// Policies only learn card faces through Observe, like a human watching the
+// table would.
+class MovePolicy {
+public:
+  virtual ~MovePolicy() = default;
+
+  // Called before every game
+  virtual void Reset(std::uint32_t board_size, std::uint64_t seed) = 0;
+
+  // Return flat index (x * board_size + y) of a face down card to select
+  virtual std::uint32_t ChooseCard(const MemoryLogic &logic) = 0;
+
+  // Called for every card turned face up, by any player
+  virtual void Observe(std::uint32_t /*index*/, CardId /*card*/) {}
+
+  // Called when a pair has been matched, by any player
+  virtual void ObserveMatch(std::uint32_t /*first_index*/,
+                            std::uint32_t /*second_index*/) {}
+};
+
+// Creates one policy instance per simulated player
+using PolicyFactory = std::function<std::unique_ptr<MovePolicy>()>;
+
+// Select a random face down card, remember nothing
+class RandomPolicy : public MovePolicy {
+public:
+  void Reset(std::uint32_t board_size, std::uint64_t seed) override;
+
+  std::uint32_t ChooseCard(const MemoryLogic &logic) override;
+
+protected:
+  // Return random face down card, preferring cards not set in excluded
+  // (nullptr for none). Costs one pass over the mask words.
+  std::uint32_t RandomFaceDownCard(const MemoryLogic &logic,
+                                   const DynamicPackedBoolArray *excluded);
+
+  std::uint32_t m_BoardSize = 0;
+
+  Xoshiro256PlusPlus m_Rng{}; // Move randomness
+};
+
+// Remember up to capacity most recently seen cards and play known pairs.
+// With a half_life above 0 memories also fade: a remembered card is
+// forgotten after a random number of later observations, half of them
+// within half_life.
+class LimitedMemoryPolicy : public RandomPolicy {
+public:
+  explicit LimitedMemoryPolicy(std::size_t capacity, double half_life = 0.0);
+
+  void Reset(std::uint32_t board_size, std::uint64_t seed) override;
+
+  std::uint32_t ChooseCard(const MemoryLogic &logic) override;
+
+  void Observe(std::uint32_t index, CardId card) override;
+
+  void ObserveMatch(std::uint32_t first_index,
+                    std::uint32_t second_index) override;
+
+protected:
+  // Remember card at index as the newest memory
+  void Remember(std::uint32_t index, CardId card);
+
+  // Forget card at index
+  void Forget(std::uint32_t index);
+
+  // Return remembered face down card equal to card other than index, or
+  // kNoCard
+  std::uint32_t FindPartner(const MemoryLogic &logic, std::uint32_t index,
+                            CardId card) const;
+
+  static constexpr std::uint32_t kNoCard = UINT32_MAX;
+
+  static constexpr CardId kUnknownCard = UINT32_MAX; // Not remembered
+
+  // Forget memories whose time ran out
+  void ForgetFaded();
+
+  std::size_t m_Capacity; // How many cards can be remembered at once
+
+  // Chance of a memory surviving one more observation, 1 without decay
+  double m_Retention;
+
+  std::uint64_t m_Clock = 0; // Observations so far
+
+  // Observation at which each index fades, and a min heap of (observation,
+  // index) holding stale entries of indices forgotten or seen again since
+  std::vector<std::uint64_t> m_FadesAt{};
+  std::vector<std::pair<std::uint64_t, std::uint32_t>> m_Fading{};
+
+  std::vector<CardId> m_Memory{}; // Remembered card per index, kUnknownCard
+                                  // if unknown
+
+  DynamicPackedBoolArray m_Known{}; // Whether index is remembered
+
+  std::vector<std::uint64_t> m_Age{}; // When each index was remembered
+  std::uint64_t m_NextAge = 0;
+
+  // Remembered indices oldest first, as a list linked through the arrays
+  std::vector<std::uint32_t> m_Newer{};
+  std::vector<std::uint32_t> m_Older{};
+  std::uint32_t m_Oldest = kNoCard;
+  std::uint32_t m_Newest = kNoCard;
+  std::size_t m_RememberedCount = 0;
+
+  std::vector<std::array<std::uint32_t, 2>>
+      m_Cells{}; // Remembered indices of each card, kNoCard if unknown
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t>>
+      m_Pairs{}; // Pairs with both cards remembered, sorted by age of the
+                 // older card, with its index. Players use known pairs
+                 // quickly, so this stays short.
+
+  std::uint32_t m_FirstIndex = kNoCard; // First card selected this turn
+  CardId m_FirstCard = 0;               // Face of the first card
+};
+
+// Remember every card ever seen
+class PerfectMemoryPolicy : public LimitedMemoryPolicy {
+public:
+  PerfectMemoryPolicy() : LimitedMemoryPolicy(SIZE_MAX) {}
+};
+
+// Return factory for policy name: "random", "perfect", "optimal",
+// "limited:<capacity>" or "decay:<capacity>:<half life>". Returns empty
+// factory if the name is not recognized.
+PolicyFactory ParsePolicy(std::string_view name);
+
+// Show the card just selected at index to every policy, nullptr entries are
+// skipped. status is the game status before the selection, first_index the
+// first card of the turn, updated by the call.
+void ObserveSelection(const MemoryLogic &logic,
+                      std::span<const std::unique_ptr<MovePolicy>> policies,
+                      GameStatus status, std::uint32_t index,
+                      std::uint32_t &first_index);
+
+// Outcome of a single game
+struct GameResult {
+  std::uint32_t turn_number = 0;        // MemoryLogic::GetTurnNumber()
+  std::vector<std::uint32_t> winners{}; // MemoryLogic::GetWinners()
+};
+
+// Initialize board in logic from seed and play it to the end. Each player
+// uses the policy at its index.
+GameResult PlayGame(MemoryLogic &logic,
+                    std::vector<std::unique_ptr<MovePolicy>> &policies,
+                    std::uint64_t seed);
+
+// Batch simulation parameters
+struct SimulationConfig {
+  std::uint32_t board_size = 4;
+  std::uint32_t player_count = 2;
+  std::uint64_t game_count = 1000;
+
+  // Worker threads, 0 means std::thread::hardware_concurrency()
+  std::uint32_t thread_count = 0;
+
+  // Game i always plays with the same seed derived from this one, regardless
+  // of thread count
+  std::uint64_t seed = 0;
+
+  PolicyFactory policy_factory = [] {
+    return std::make_unique<RandomPolicy>();
+  };
+};
+
+// Aggregated results of a batch simulation
+struct SimulationResult {
+  std::uint64_t game_count = 0;
+  std::uint32_t thread_count = 0;
+  double elapsed_seconds = 0.0;
+
+  // Turn number at the end of game -> number of games
+  std::map<std::uint32_t, std::uint64_t> turn_histogram{};
+
+  // Games won per player (shared wins included)
+  std::vector<std::uint64_t> wins{};
+
+  // Games with more than one winner
+  std::uint64_t tied_games = 0;
+
+  // Add other result to this one
+  void Merge(const SimulationResult &other);
+
+  // Return simulated games per second
+  double GamesPerSecond() const;
+
+  // Return average turn number at the end of game
+  double MeanTurns() const;
+};
+
+// Play config.game_count games in parallel
+SimulationResult RunSimulation(const SimulationConfig &config);
+
+} // namespace memory_game
@@ -0,0 +1,162 @@
+// header
+#include "work_stealing_pool.hpp"
+
+// std
+#include <algorithm>
+
+namespace memory_game {
+
+WorkStealingPool::WorkStealingPool(std::uint32_t thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (std::uint32_t i = 0; i < thread_count; i++) {
+    m_Queues.push_back(std::make_unique<Queue>());
+  }
+
+  for (std::uint32_t i = 1; i < thread_count; i++) {
+    m_Threads.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Stopping = true;
+  }
+
+  m_Start.notify_all();
+
+  for (auto &thread : m_Threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::Run(std::size_t count, std::size_t chunk_size,
+                           const Body &body) {
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+
+  // Deal chunks round robin, so every thread starts with its share
+  const std::size_t thread_count = m_Queues.size();
+  std::size_t next = 0;
+  for (std::size_t begin = 0; begin < count; begin += chunk_size) {
+    m_Queues[next]->chunks.emplace_back(begin,
+                                        std::min(count, begin + chunk_size));
+    next = (next + 1) % thread_count;
+  }
+
+  {
+    std::lock_guard lock(m_Mutex);
+    m_Body = &body;
+    m_Error = nullptr;
+    m_Failed = false;
+    m_Running = static_cast<std::uint32_t>(m_Threads.size());
+    m_Generation++;
+  }
+
+  m_Start.notify_all();
+
+  Work(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(m_Mutex);
+    m_Done.wait(lock, [this] { return m_Running == 0; });
+
+    m_Body = nullptr;
+    error = std::exchange(m_Error, nullptr);
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkStealingPool::WorkerLoop(std::uint32_t thread_index) {
+  std::uint64_t generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock lock(m_Mutex);
+      m_Start.wait(lock, [&] {
+        return m_Stopping || m_Generation != generation;
+      });
+
+      if (m_Stopping) {
+        return;
+      }
+
+      generation = m_Generation;
+    }
+
+    Work(thread_index);
+
+    {
+      std::lock_guard lock(m_Mutex);
+      m_Running--;
+    }
+
+    m_Done.notify_one();
+  }
+}
+
+void WorkStealingPool::Work(std::uint32_t thread_index) {
+  const Body *body = nullptr;
+  {
+    std::lock_guard lock(m_Mutex);
+    body = m_Body;
+  }
+
+  std::pair<std::size_t, std::size_t> chunk{};
+
+  while (TakeChunk(thread_index, chunk)) {
+    {
+      std::lock_guard lock(m_Mutex);
+      if (m_Failed) {
+        continue; // Drain the queues without running the body
+      }
+    }
+
+    try {
+      (*body)(chunk.first, chunk.second, thread_index);
+    } catch (...) {
+      std::lock_guard lock(m_Mutex);
+      if (!m_Failed) {
+        m_Failed = true;
+        m_Error = std::current_exception();
+      }
+    }
+  }
+}
+
+bool WorkStealingPool::TakeChunk(std::uint32_t thread_index,
+                                 std::pair<std::size_t, std::size_t> &chunk) {
+  const std::size_t thread_count = m_Queues.size();
+
+  // Own chunks from the back
+  {
+    Queue &own = *m_Queues[thread_index];
+    std::lock_guard lock(own.mutex);
+    if (!own.chunks.empty()) {
+      chunk = own.chunks.back();
+      own.chunks.pop_back();
+      return true;
+    }
+  }
+
+  // Steal from the front of the others
+  for (std::size_t i = 1; i < thread_count; i++) {
+    Queue &victim = *m_Queues[(thread_index + i) % thread_count];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.chunks.empty()) {
+      chunk = victim.chunks.front();
+      victim.chunks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace memory_game
@@ -0,0 +1,84 @@
+#pragma once
+
+// std
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace memory_game {
+
+// Fixed set of threads running parallel loops.
+//
+// Run splits the loop into chunks dealt evenly onto one deque per thread.
+// Every thread takes chunks from the back of its own deque and, once that is
+// empty, steals from the front of the others', so threads that drew cheap
+// chunks help out with expensive ones instead of idling.
+class WorkStealingPool {
+public:
+  // Loop body, called with a chunk [begin, end) and the index of the thread
+  // running it
+  using Body = std::function<void(std::size_t begin, std::size_t end,
+                                  std::uint32_t thread_index)>;
+
+  // Start thread_count - 1 threads, the thread calling Run works too. 0 means
+  // std::thread::hardware_concurrency().
+  explicit WorkStealingPool(std::uint32_t thread_count = 0);
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // Join the threads
+  ~WorkStealingPool();
+
+  // Return number of threads running loops, the caller included
+  std::uint32_t GetThreadCount() const {
+    return static_cast<std::uint32_t>(m_Queues.size());
+  }
+
+  // Run body over [0, count) in chunks of chunk_size and return once all are
+  // done. Rethrows the first exception a chunk threw, the remaining chunks
+  // are skipped then. Not reentrant.
+  void Run(std::size_t count, std::size_t chunk_size, const Body &body);
+
+private:
+  // Chunks of one thread
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::pair<std::size_t, std::size_t>> chunks{};
+  };
+
+  // Thread loop waiting for Run
+  void WorkerLoop(std::uint32_t thread_index);
+
+  // Run chunks, own first, until none is left anywhere
+  void Work(std::uint32_t thread_index);
+
+  // Take a chunk of thread_index's own queue or steal one, returns false if
+  // every queue is empty
+  bool TakeChunk(std::uint32_t thread_index,
+                 std::pair<std::size_t, std::size_t> &chunk);
+
+  std::vector<std::unique_ptr<Queue>> m_Queues{};
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Start;
+  std::condition_variable m_Done;
+  std::uint64_t m_Generation = 0;   // Guarded by m_Mutex, counts Run calls
+  std::uint32_t m_Running = 0;      // Guarded by m_Mutex, busy threads
+  bool m_Stopping = false;          // Guarded by m_Mutex
+  const Body *m_Body = nullptr;     // Guarded by m_Mutex
+  std::exception_ptr m_Error{};     // Guarded by m_Mutex
+  bool m_Failed = false;            // Guarded by m_Mutex
+
+  std::vector<std::thread> m_Threads{}; // Started last
+};
+
+} // namespace memory_game
@@ -0,0 +1,136 @@
+// local
+#include "autosave.hpp"
+#include "memory_logic.hpp"
+#include "test_check.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace memory_game;
+
+namespace {
+
+std::vector<std::byte> Serialize(const MemoryLogic &logic) {
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+  return image;
+}
+
+// Xor byte at offset of file with mask
+void FlipByte(const std::filesystem::path &filename, std::uint64_t offset) {
+  std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(static_cast<std::streamoff>(offset));
+  const char byte = static_cast<char>(file.get() ^ 0x40);
+  file.seekp(static_cast<std::streamoff>(offset));
+  file.put(byte);
+}
+
+} // namespace
+
+int main() {
+  const std::filesystem::path path =
+      memory_game_test::ScratchFile("autosave.dat");
+
+  MemoryLogic logic(20, 2);
+  logic.InitializeBoard(3);
+
+  std::vector<std::byte> previous{};
+  std::vector<std::byte> latest{};
+
+  // Every commit reads back exactly, also after reopening
+  {
+    Autosave autosave(path);
+
+    std::vector<std::byte> image{};
+    CHECK(!autosave.ReadLatest(image));
+
+    for (std::uint32_t i = 0; i < 40; i++) {
+      logic.SelectCard(i * 7 % 20, i * 3 % 20);
+      CHECK(autosave.Commit(logic));
+
+      previous = latest;
+      latest = Serialize(logic);
+
+      CHECK(autosave.ReadLatest(image));
+      CHECK(image == latest);
+    }
+  }
+
+  {
+    Autosave autosave(path);
+
+    std::vector<std::byte> image{};
+    CHECK(autosave.ReadLatest(image));
+    CHECK(image == latest);
+
+    // Keeps committing into the reopened file
+    logic.SelectCard(1, 1);
+    CHECK(autosave.Commit(logic));
+    previous = latest;
+    latest = Serialize(logic);
+
+    CHECK(autosave.ReadLatest(image));
+    CHECK(image == latest);
+  }
+
+  // A torn commit record falls back to the other slot's older state
+  {
+    AutosaveRecord records[2]{};
+    std::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(&records[0]), sizeof(records[0]));
+    file.seekg(512);
+    file.read(reinterpret_cast<char *>(&records[1]), sizeof(records[1]));
+    file.close();
+
+    const std::uint64_t newest =
+        records[1].generation > records[0].generation ? 1 : 0;
+    FlipByte(path, newest * 512 + 20);
+
+    Autosave autosave(path);
+    std::vector<std::byte> image{};
+    CHECK(autosave.ReadLatest(image));
+    CHECK(image == previous);
+
+    MemoryLogic loaded{};
+    CHECK(loaded.LoadStateFromImage(image));
+  }
+
+  // So does a corrupted image in the newest slot. The commit goes to the slot
+  // of the torn record, the other one still holds the older state.
+  {
+    Autosave autosave(path);
+    logic.SelectCard(2, 2);
+    CHECK(autosave.Commit(logic));
+
+    std::vector<std::byte> image{};
+    CHECK(autosave.ReadLatest(image));
+    CHECK(image == Serialize(logic));
+  }
+  {
+    AutosaveRecord records[2]{};
+    std::ifstream file(path, std::ios::binary);
+    file.read(reinterpret_cast<char *>(&records[0]), sizeof(records[0]));
+    file.seekg(512);
+    file.read(reinterpret_cast<char *>(&records[1]), sizeof(records[1]));
+    file.close();
+
+    const AutosaveRecord &newest =
+        records[1].generation > records[0].generation ? records[1]
+                                                      : records[0];
+    FlipByte(path, newest.slot_offset + newest.image_size / 2);
+
+    Autosave autosave(path);
+    std::vector<std::byte> image{};
+    CHECK(autosave.ReadLatest(image));
+    CHECK(image == previous);
+  }
+
+  std::error_code error{};
+  std::filesystem::remove(path, error);
+
+  return memory_game_test::Finish();
+}
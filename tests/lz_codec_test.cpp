@@ -0,0 +1,104 @@
+// local
+#include "lz_codec.hpp"
+#include "memory_logic.hpp"
+#include "test_check.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace memory_game;
+
+namespace {
+
+// Compress data and check it decompresses back to it, and fails to
+// decompress to any other size
+void CheckRoundTrip(const std::vector<std::byte> &data) {
+  std::vector<std::byte> compressed{};
+  LzCompress(data, compressed);
+
+  std::vector<std::byte> output(data.size());
+  CHECK(LzDecompress(compressed, output));
+  CHECK(output == data);
+
+  std::vector<std::byte> longer(data.size() + 1);
+  CHECK(!LzDecompress(compressed, longer));
+
+  if (!data.empty()) {
+    std::vector<std::byte> shorter(data.size() - 1);
+    CHECK(!LzDecompress(compressed, shorter));
+  }
+
+  // Every cut short stream must fail cleanly, an empty one is a valid empty
+  // output
+  for (std::size_t size = data.empty() ? 1 : 0; size < compressed.size();
+       size += 1 + compressed.size() / 64) {
+    CHECK(!LzDecompress(std::span(compressed).first(size), output));
+  }
+}
+
+std::vector<std::byte> RandomBytes(std::mt19937 &rng, std::size_t size,
+                                   unsigned alphabet) {
+  std::vector<std::byte> data(size);
+  for (std::byte &byte : data) {
+    byte = static_cast<std::byte>(rng() % alphabet);
+  }
+  return data;
+}
+
+} // namespace
+
+int main() {
+  std::mt19937 rng(1);
+
+  CheckRoundTrip({});
+  CheckRoundTrip({std::byte{42}});
+  CheckRoundTrip(std::vector<std::byte>(100000, std::byte{0}));
+  CheckRoundTrip(RandomBytes(rng, 10000, 256)); // Incompressible
+  CheckRoundTrip(RandomBytes(rng, 10000, 3));   // Short matches
+
+  // Literal runs and matches past the 15 and 270 length escapes, and
+  // matches reaching back almost the whole 64 KiB window
+  {
+    std::vector<std::byte> data = RandomBytes(rng, 300, 256);
+    const std::vector<std::byte> block = RandomBytes(rng, 65000, 256);
+    data.insert(data.end(), block.begin(), block.end());
+    data.insert(data.end(), 1000, std::byte{7});
+    data.insert(data.end(), block.begin(), block.begin() + 5000);
+    CheckRoundTrip(data);
+  }
+
+  // Save images, what the codec is for
+  for (const std::uint32_t size : {2u, 8u, 40u}) {
+    MemoryLogic logic(size, 3);
+    logic.InitializeBoard(size);
+    for (std::uint32_t i = 0; i < size * 3; i++) {
+      logic.SelectCard(i * 7 % size, i * 5 % size);
+    }
+
+    std::vector<std::byte> image{};
+    logic.SerializeState(image);
+    CheckRoundTrip(image);
+  }
+
+  // Garbage must never read or write out of bounds, it's caught by the
+  // sanitizers if it does
+  for (int i = 0; i < 2000; i++) {
+    const std::vector<std::byte> garbage =
+        RandomBytes(rng, rng() % 64, i % 2 == 0 ? 256 : 16);
+    std::vector<std::byte> output(rng() % 256);
+    LzDecompress(garbage, output);
+  }
+
+  // Offsets pointing before the start of the output
+  {
+    const std::vector<std::byte> bad = {std::byte{0x10}, std::byte{1},
+                                        std::byte{2}, std::byte{0}};
+    std::vector<std::byte> output(5);
+    CHECK(!LzDecompress(bad, output));
+  }
+
+  return memory_game_test::Finish();
+}
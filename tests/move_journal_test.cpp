@@ -0,0 +1,114 @@
+// local
+#include "memory_logic.hpp"
+#include "move_journal.hpp"
+#include "test_check.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace memory_game;
+
+namespace {
+
+std::vector<std::byte> Serialize(const MemoryLogic &logic) {
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+  return image;
+}
+
+// Play moves selections on logic
+void Play(MemoryLogic &logic, std::uint32_t moves) {
+  const std::uint32_t size = logic.GetBoardSize();
+  for (std::uint32_t i = 0; i < moves; i++) {
+    logic.SelectCard(i * 7 % size, i * 11 % size);
+  }
+}
+
+// Check journal image parses and replays to expected, and that every
+// flipped byte is rejected
+void CheckJournalImage(const std::vector<std::byte> &image,
+                       const std::vector<std::byte> &expected) {
+  std::string error{};
+
+  MoveJournal parsed{};
+  CHECK(parsed.Parse(image, error));
+
+  MemoryLogic replayed{};
+  CHECK(JournalReplay(parsed).Seek(parsed.GetMoveCount(), replayed));
+  CHECK(Serialize(replayed) == expected);
+
+  for (std::size_t i = 0; i < image.size(); i++) {
+    std::vector<std::byte> corrupted = image;
+    corrupted[i] ^= std::byte{0x10};
+
+    MoveJournal rejected{};
+    CHECK(!rejected.Parse(corrupted, error));
+  }
+
+  MoveJournal truncated{};
+  CHECK(!truncated.Parse(std::span(image).first(image.size() - 1), error));
+}
+
+} // namespace
+
+int main() {
+  // Journal of a board dealt from a seed
+  {
+    MoveJournal journal{};
+    MemoryLogic logic(6, 2);
+    logic.SetJournal(&journal);
+    logic.InitializeBoard(42);
+    Play(logic, 60);
+
+    std::vector<std::byte> image{};
+    journal.Serialize(image);
+    CheckJournalImage(image, Serialize(logic));
+  }
+
+  // Journal starting from a snapshot of a game in progress, on a board whose
+  // moves take two bytes
+  {
+    MemoryLogic logic(16, 3);
+    logic.InitializeBoard(7);
+    Play(logic, 30);
+
+    MoveJournal journal{};
+    logic.SetJournal(&journal);
+    Play(logic, 200);
+
+    std::vector<std::byte> image{};
+    journal.Serialize(image);
+    CheckJournalImage(image, Serialize(logic));
+
+    // Seeking back reproduces an earlier state
+    MemoryLogic replayed{};
+    CHECK(JournalReplay(journal, 16).Seek(0, replayed));
+    CHECK(replayed.GetBoardSize() == 16);
+  }
+
+  // Save and load through a file
+  {
+    const std::filesystem::path path =
+        memory_game_test::ScratchFile("journal.dat");
+
+    MoveJournal journal{};
+    MemoryLogic logic(4, 2);
+    logic.SetJournal(&journal);
+    logic.InitializeBoard(1);
+    Play(logic, 20);
+
+    CHECK(journal.Save(path));
+
+    MoveJournal loaded{};
+    CHECK(loaded.Load(path));
+    CHECK(loaded.GetMoveCount() == journal.GetMoveCount());
+
+    std::error_code error{};
+    std::filesystem::remove(path, error);
+  }
+
+  return memory_game_test::Finish();
+}
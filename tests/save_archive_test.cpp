@@ -0,0 +1,166 @@
+// local
+#include "memory_logic.hpp"
+#include "save_archive.hpp"
+#include "test_check.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace memory_game;
+
+namespace {
+
+// Save image of a game dealt from seed
+std::vector<std::byte> MakeImage(std::uint32_t size, std::uint64_t seed) {
+  MemoryLogic logic(size, 2);
+  logic.InitializeBoard(seed);
+  logic.SelectCard(0, 0);
+
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+  return image;
+}
+
+// Check archive holds exactly images, in order, with timestamps 0, 1, ...
+void CheckContents(const SaveArchive &archive,
+                   const std::vector<std::vector<std::byte>> &images) {
+  CHECK(archive.GetCount() == images.size());
+
+  const std::vector<ArchiveEntry> entries = archive.List(0, images.size());
+  CHECK(entries.size() == images.size());
+
+  for (std::size_t i = 0; i < entries.size() && i < images.size(); i++) {
+    std::vector<std::byte> image{};
+    CHECK(archive.Load(entries[i].id, image));
+    CHECK(image == images[i]);
+    CHECK(entries[i].timestamp == static_cast<std::int64_t>(i));
+  }
+}
+
+// Xor byte at offset of file with mask
+void FlipByte(const std::filesystem::path &filename, std::uint64_t offset) {
+  std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+  file.seekg(static_cast<std::streamoff>(offset));
+  const char byte = static_cast<char>(file.get() ^ 0x40);
+  file.seekp(static_cast<std::streamoff>(offset));
+  file.put(byte);
+}
+
+} // namespace
+
+int main() {
+  const std::filesystem::path directory = memory_game_test::ScratchFile("archive");
+  const std::filesystem::path pack = directory / "saves.pack";
+  const std::filesystem::path index = directory / "saves.pack.idx";
+
+  std::vector<std::vector<std::byte>> images{};
+  for (std::uint64_t i = 0; i < 20; i++) {
+    images.push_back(MakeImage(i % 2 == 0 ? 4 : 40, i));
+  }
+
+  // Append one by one and as a batch, then reopen
+  {
+    SaveArchive archive(pack);
+    CHECK(archive.IsOpen());
+
+    for (std::size_t i = 0; i < 10; i++) {
+      CHECK(archive.Append(images[i], static_cast<std::int64_t>(i)));
+    }
+
+    std::vector<ArchiveSave> batch{};
+    for (std::size_t i = 10; i < images.size(); i++) {
+      batch.push_back({images[i], static_cast<std::int64_t>(i)});
+    }
+    CHECK(archive.AppendBatch(batch));
+
+    CheckContents(archive, images);
+  }
+
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+  }
+
+  // Without the index every record is found by scanning the pack
+  std::filesystem::remove(index);
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+  }
+
+  // A corrupted index entry is dropped together with the entries after it
+  // and the records are scanned again
+  FlipByte(index, 5 * sizeof(ArchiveEntry) + 8);
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+  }
+
+  // Torn tail: the last record was cut short by a crash. It's left out, and
+  // the next save overwrites it.
+  std::filesystem::resize_file(pack, std::filesystem::file_size(pack) - 10);
+  images.pop_back();
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+
+    images.push_back(MakeImage(6, 99));
+    CHECK(archive.Append(images.back(), images.size() - 1));
+    CheckContents(archive, images);
+  }
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+  }
+
+  // Corrupted save data fails to load instead of returning wrong bytes
+  {
+    SaveArchive archive(pack);
+    const ArchiveEntry entry = archive.List(3, 1).at(0);
+    FlipByte(pack, entry.id + sizeof(ArchiveRecordHeader) + 4);
+
+    std::vector<std::byte> image{};
+    CHECK(!archive.Load(entry.id, image));
+    CHECK(archive.Load(archive.List(4, 1).at(0).id, image));
+    FlipByte(pack, entry.id + sizeof(ArchiveRecordHeader) + 4);
+  }
+
+  // Two handles on one pack, as with two processes: each appends after the
+  // other's records instead of over them
+  {
+    SaveArchive first(pack);
+    SaveArchive second(pack);
+
+    images.push_back(MakeImage(4, 100));
+    CHECK(first.Append(images.back(), images.size() - 1));
+    images.push_back(MakeImage(4, 101));
+    CHECK(second.Append(images.back(), images.size() - 1));
+
+    CheckContents(second, images);
+    CHECK(first.Refresh());
+    CheckContents(first, images);
+  }
+  {
+    SaveArchive archive(pack);
+    CheckContents(archive, images);
+  }
+
+  // Files that aren't packs are left alone
+  {
+    const std::filesystem::path other = directory / "other.pack";
+    std::ofstream(other) << "not a pack at all";
+
+    SaveArchive archive(other);
+    CHECK(!archive.IsOpen());
+    CHECK(!archive.Append(images[0], 0));
+  }
+
+  std::error_code error{};
+  std::filesystem::remove_all(directory, error);
+
+  return memory_game_test::Finish();
+}
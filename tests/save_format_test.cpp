@@ -0,0 +1,119 @@
+// local
+#include "memory_logic.hpp"
+#include "save_format.hpp"
+#include "test_check.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace memory_game;
+
+namespace {
+
+// Serialized state of a game on a board of size with some moves played
+std::vector<std::byte> MakeImage(std::uint32_t size,
+                                 std::uint32_t player_count) {
+  MemoryLogic logic(size, player_count);
+  logic.InitializeBoard(size * 31 + player_count);
+  for (std::uint32_t i = 0; i < size * 4; i++) {
+    logic.SelectCard(i * 3 % size, i * 5 % size);
+  }
+
+  std::vector<std::byte> image{};
+  logic.SerializeState(image);
+  return image;
+}
+
+bool Parses(const std::vector<std::byte> &image) {
+  std::string error{};
+  return SaveView::Parse(image, error).has_value();
+}
+
+} // namespace
+
+int main() {
+  // Round trip at every card width
+  for (const std::uint32_t size : {2u, 6u, 24u, 364u}) {
+    const std::vector<std::byte> image = MakeImage(size, 3);
+    CHECK(Parses(image));
+
+    MemoryLogic loaded{};
+    CHECK(loaded.LoadStateFromImage(image));
+    CHECK(loaded.GetBoardSize() == size);
+
+    std::vector<std::byte> again{};
+    loaded.SerializeState(again);
+    CHECK(again == image);
+  }
+
+  // Any flipped byte is caught by a CRC or a header check
+  {
+    const std::vector<std::byte> image = MakeImage(6, 2);
+    for (std::size_t i = 0; i < image.size(); i++) {
+      std::vector<std::byte> corrupted = image;
+      corrupted[i] ^= std::byte{0x20};
+      CHECK(!Parses(corrupted));
+    }
+
+    CHECK(!Parses(std::vector<std::byte>(image.begin(), image.end() - 8)));
+    CHECK(!Parses({}));
+  }
+
+  // Resealed images must still deal every pair exactly twice
+  {
+    std::vector<std::byte> image = MakeImage(4, 2);
+    const SaveHeader header = *reinterpret_cast<SaveHeader *>(image.data());
+    const SaveLayout layout =
+        SaveLayout::For(header.board_size, header.player_count,
+                        header.card_width);
+
+    std::vector<std::byte> out_of_range = image;
+    const CardId pair_count = 8;
+    StoreBoard(out_of_range, layout, &pair_count, 1);
+    SealSaveImage(out_of_range);
+    CHECK(!Parses(out_of_range));
+
+    // Card 0 takes the id of another card, leaving its pair with one card
+    std::string error{};
+    std::vector<CardId> cards(16);
+    SaveView::Parse(image, error)->CopyBoard(cards.data());
+    std::size_t other = 1;
+    while (cards[other] == cards[0]) {
+      other++;
+    }
+
+    std::vector<std::byte> unpaired = image;
+    StoreBoard(unpaired, layout, &cards[other], 1);
+    SealSaveImage(unpaired);
+    CHECK(!Parses(unpaired));
+
+    // Odd boards can't be dealt
+    std::vector<std::byte> odd = image;
+    reinterpret_cast<SaveHeader *>(odd.data())->board_size = 3;
+    SealSaveImage(odd);
+    CHECK(!Parses(odd));
+  }
+
+  // A rejected image leaves the loaded game untouched
+  {
+    MemoryLogic logic(8, 2);
+    logic.InitializeBoard(5);
+
+    std::vector<std::byte> before{};
+    logic.SerializeState(before);
+
+    std::vector<std::byte> corrupted = MakeImage(4, 3);
+    corrupted[corrupted.size() / 2] ^= std::byte{1};
+    CHECK(!logic.LoadStateFromImage(corrupted));
+
+    std::vector<std::byte> after{};
+    logic.SerializeState(after);
+    CHECK(after == before);
+  }
+
+  return memory_game_test::Finish();
+}
@@ -0,0 +1,55 @@
+/*
+ *
+ * Minimal check helpers for the tests. Each test is a plain executable run by
+ * CTest that reports every failed check and exits with failure if any did.
+ *
+ */
+
+#pragma once
+
+// std
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+
+namespace memory_game_test {
+
+// Number of failed checks so far
+inline int g_Failures = 0;
+
+inline void Check(bool condition, const char *expression, const char *file,
+                  int line) {
+  if (!condition) {
+    std::cerr << file << ":" << line << ": check failed: " << expression
+              << "\n";
+    g_Failures++;
+  }
+}
+
+// Return exit code of the test
+inline int Finish() {
+  if (g_Failures != 0) {
+    std::cerr << g_Failures << " checks failed\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Return path of a scratch file in the temporary directory, removing any
+// file left there by an earlier run
+inline std::filesystem::path ScratchFile(const std::string &name) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / ("memory_game_test_" + name);
+
+  std::error_code error{};
+  std::filesystem::remove_all(path, error);
+  return path;
+}
+
+} // namespace memory_game_test
+
+#define CHECK(condition)                                                       \
+  ::memory_game_test::Check(static_cast<bool>(condition), #condition,          \
+                            __FILE__, __LINE__)